@@ -159,6 +159,32 @@ private:
   static inline std::vector<Counter *> instances;
 };
 
+// LabeledCounter is a histogram, i.e. a set of counters indexed by small
+// integers such as relocation types. Labels are converted to strings
+// only when the results are printed.
+class LabeledCounter {
+public:
+  LabeledCounter(std::string_view name, std::string (*to_string)(u32));
+
+  void add(u32 label, i64 delta = 1) {
+    if (Counter::enabled) [[unlikely]] {
+      std::vector<i64> &vec = values.local();
+      if (vec.size() <= label)
+        vec.resize(label + 1);
+      vec[label] += delta;
+    }
+  }
+
+  static void print();
+
+private:
+  std::string_view name;
+  std::string (*to_string)(u32);
+  tbb::enumerable_thread_specific<std::vector<i64>> values;
+
+  static inline std::vector<LabeledCounter *> instances;
+};
+
 // Timer and TimeRecord records elapsed time (wall clock time)
 // used by each pass of the linker.
 struct TimerRecord {
@@ -178,6 +204,11 @@ struct TimerRecord {
 void
 print_timer_records(tbb::concurrent_vector<std::unique_ptr<TimerRecord>> &);
 
+i64 get_major_page_faults();
+i64 get_process_cpu_time();
+i64 get_thread_cpu_time();
+i64 now_nsec();
+
 template <typename Context>
 class Timer {
 public:
@@ -196,6 +227,17 @@ public:
     record->stop();
   }
 
+  // Adds a child record that ends now and took `nsec` of wall-clock
+  // time. This is for a number that is computed rather than measured.
+  void add_child(Context &ctx, std::string name, i64 nsec) {
+    TimerRecord *rec = new TimerRecord(name, record);
+    ctx.timer_records.emplace_back(rec);
+    rec->stop();
+    rec->start = rec->end - nsec;
+    rec->user = 0;
+    rec->sys = 0;
+  }
+
 private:
   TimerRecord *record;
 };
@@ -343,6 +385,22 @@ inline void parallel_memcpy(void *dst, const void *src, i64 size) {
                     });
 }
 
+// Returns the elements of `vec` that satisfy `pred` in their original
+// order. `pred` is called in parallel.
+template <typename T>
+inline std::vector<T> parallel_filter(const std::vector<T> &vec, auto pred) {
+  constexpr i64 BLOCK_SIZE = 4096;
+  std::vector<std::vector<T>> blocks((vec.size() + BLOCK_SIZE - 1) / BLOCK_SIZE);
+
+  tbb::parallel_for((i64)0, (i64)blocks.size(), [&](i64 i) {
+    i64 end = std::min<i64>(vec.size(), (i + 1) * BLOCK_SIZE);
+    for (i64 j = i * BLOCK_SIZE; j < end; j++)
+      if (pred(vec[j]))
+        blocks[i].push_back(vec[j]);
+  });
+  return flatten(blocks);
+}
+
 inline void encode_uleb(std::vector<u8> &vec, u64 val) {
   do {
     u8 byte = val & 0x7f;
@@ -525,6 +583,26 @@ public:
       [&](T &value) { return initialize(value, key); });
   }
 
+  // Returns the value for a given key, or nullptr if not found. This
+  // must not be called concurrently with insertions.
+  T *find(std::string_view key, u64 hash) {
+    if (nbuckets == 0)
+      return nullptr;
+
+    u64 begin = hash & (nbuckets - 1);
+    u64 mask = nbuckets / NUM_SHARDS - 1;
+
+    for (i64 i = 0; i < MAX_RETRY; i++) {
+      Entry &ent = entries[(begin & ~mask) | ((begin + i) & mask)];
+      const char *ptr = ent.key.load(std::memory_order_relaxed);
+      if (!ptr)
+        return nullptr;
+      if (key == std::string_view(ptr, ent.keylen))
+        return &ent.value;
+    }
+    return nullptr;
+  }
+
   i64 get_idx(T *value) const {
     uintptr_t addr = (uintptr_t)value - (uintptr_t)value % sizeof(Entry);
     return (Entry *)addr - entries;
@@ -901,8 +979,23 @@ public:
     });
   }
 
-private:
+  // Same as parallel_for_each, but also passes the shard number and the
+  // value's position within the shard. Values are only ever appended to
+  // a shard, so the pair identifies a value for the map's lifetime and
+  // can be used to index side tables.
+  void parallel_for_each_indexed(auto fn) {
+    tbb::parallel_for((i64)0, NUM_SHARDS, [&](i64 i) {
+      Shard &shard = shards[i];
+      i64 idx = 0;
+      for (Block &block : shard.blocks)
+        for (i64 j = 0; j < block.size; j++)
+          fn(block.data[j], i, idx++);
+    });
+  }
+
   static constexpr i64 NUM_SHARDS = 64;
+
+private:
   using Entry = ShardedMapEntry<T>;
   static_assert(std::is_trivially_destructible_v<Entry>);
 
@@ -26,7 +26,40 @@ void Counter::print() {
               << "=" << c->get_value() << "\n";
 }
 
-static i64 now_nsec() {
+LabeledCounter::LabeledCounter(std::string_view name,
+                               std::string (*to_string)(u32))
+  : name(name), to_string(to_string) {
+  static std::mutex mu;
+  std::scoped_lock lock(mu);
+  instances.push_back(this);
+}
+
+void LabeledCounter::print() {
+  ranges::stable_sort(instances, {}, &LabeledCounter::name);
+
+  for (LabeledCounter *c : instances) {
+    std::vector<i64> sum;
+    for (std::vector<i64> &v : c->values) {
+      if (sum.size() < v.size())
+        sum.resize(v.size());
+      for (i64 i = 0; i < v.size(); i++)
+        sum[i] += v[i];
+    }
+
+    std::vector<std::pair<i64, u32>> vec;
+    for (i64 i = 0; i < sum.size(); i++)
+      if (sum[i])
+        vec.push_back({sum[i], i});
+    ranges::sort(vec);
+
+    for (auto [val, label] : vec)
+      std::cout << std::setw(20) << std::right
+                << (std::string(c->name) + "[" + c->to_string(label) + "]")
+                << "=" << val << "\n";
+  }
+}
+
+i64 now_nsec() {
   return (i64)std::chrono::steady_clock::now().time_since_epoch().count();
 }
 
@@ -50,6 +83,41 @@ static std::pair<i64, i64> get_usage() {
 #endif
 }
 
+// Returns the number of page faults that required reading from disk,
+// which tells us if input files were in the page cache.
+i64 get_major_page_faults() {
+#ifdef _WIN32
+  return 0;
+#else
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_majflt;
+#endif
+}
+
+// Returns the CPU time consumed by all threads of this process.
+i64 get_process_cpu_time() {
+  auto [user, sys] = get_usage();
+  return user + sys;
+}
+
+// Returns the CPU time consumed by the calling thread.
+i64 get_thread_cpu_time() {
+#ifdef _WIN32
+  auto to_nsec = [](FILETIME t) -> i64 {
+    return (((u64)t.dwHighDateTime << 32) + (u64)t.dwLowDateTime) * 100;
+  };
+
+  FILETIME creation, exit, kernel, user;
+  GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+  return to_nsec(user) + to_nsec(kernel);
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return (i64)ts.tv_sec * 1'000'000'000 + ts.tv_nsec;
+#endif
+}
+
 TimerRecord::TimerRecord(std::string name, TimerRecord *parent)
   : name(name), parent(parent) {
   start = now_nsec();
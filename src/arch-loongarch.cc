@@ -386,6 +386,7 @@ void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
         // Rewrite pcalau12i + addi.d with pcaddi. The high part vanishes and
         // the low part becomes the pcaddi's PC-relative relocation.
         assert(removed_bytes == 4);
+        check_branch(S + A - P, -(1 << 21), 1 << 21);
         *(ul32 *)loc = 0x1800'0000 | get_rd(*(ul32 *)loc); // pcaddi
         write_j20(loc, (S + A - P) >> 2);
         rewrite(i, R_NONE);
@@ -431,6 +432,7 @@ void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
         // Rewrite pcalau12i + ld.d with pcaddi. The high part vanishes and the
         // low part becomes the pcaddi's PC-relative relocation.
         assert(removed_bytes == 4);
+        check_branch(S + A - P, -(1 << 21), 1 << 21);
         *(ul32 *)loc = 0x1800'0000 | get_rd(*(ul32 *)loc); // pcaddi
         write_j20(loc, (S + A - P) >> 2);
         rewrite(i, R_NONE);
@@ -547,6 +549,7 @@ void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
       } else {
         // Rewrite PCADDU18I + JIRL to B or BL
         assert(removed_bytes == 4);
+        check_branch(S + A - P, -(1 << 27), 1 << 27);
         if (get_rd(*(ul32 *)(buf + rel.r_offset + 4)) == 0)
           *(ul32 *)loc = 0x5000'0000; // B
         else
@@ -894,12 +897,18 @@ void InputSection<E>::scan_relocations(Context<E> &ctx) {
   }
 }
 
+// Scan relocations to shrink a given section. If `undo_only` is true,
+// we don't relax relocations further but only undo relaxations that are
+// no longer valid.
 template <>
-void shrink_section(Context<E> &ctx, InputSection<E> &isec) {
+ShrinkResult shrink_section(Context<E> &ctx, InputSection<E> &isec,
+                            RelaxCounters &counters, bool undo_only) {
   std::span<const ElfRel<E>> rels = isec.get_rels(ctx);
+  RelocDeltaCursor prev(isec.extra.r_deltas);
   std::vector<RelocDelta> deltas;
   i64 r_delta = 0;
   u8 *buf = isec.contents;
+  ShrinkResult res;
 
   for (i64 i = 0; i < rels.size(); i++) {
     const ElfRel<E> &r = rels[i];
@@ -951,6 +960,9 @@ void shrink_section(Context<E> &ctx, InputSection<E> &isec) {
     if (sym.file == ctx.internal_obj)
       continue;
 
+    // The number of bytes we can remove at this relocation
+    i64 nbytes = 0;
+
     switch (r.r_type) {
     case R_LARCH_TLS_LE_HI20_R:
     case R_LARCH_TLS_LE_ADD_R:
@@ -967,7 +979,7 @@ void shrink_section(Context<E> &ctx, InputSection<E> &isec) {
       //  addi.d  $t0, $tp, <tp-offset>
       if (i64 val = sym.get_addr(ctx) + r.r_addend - ctx.tp_addr;
           is_int(val, 12))
-        remove(4);
+        nbytes = 4;
       break;
     case R_LARCH_PCALA_HI20:
       // The following two instructions are used to materialize a
@@ -989,10 +1001,12 @@ void shrink_section(Context<E> &ctx, InputSection<E> &isec) {
         u32 insn2 = *(ul32 *)(buf + rels[i].r_offset + 4);
         bool is_addi_d = (insn2 & 0xffc0'0000) == 0x02c0'0000;
 
-        if ((dist & 0b11) == 0 && is_int(dist, 22) &&
-            is_addi_d && get_rd(insn1) == get_rd(insn2) &&
-            get_rd(insn2) == get_rj(insn2))
-          remove(4);
+        if (is_addi_d && get_rd(insn1) == get_rd(insn2) &&
+            get_rd(insn2) == get_rj(insn2)) {
+          res.needs_rescan = true;
+          if ((dist & 0b11) == 0 && is_int(dist, 22))
+            nbytes = 4;
+        }
       }
       break;
     case R_LARCH_CALL36:
@@ -1004,11 +1018,12 @@ void shrink_section(Context<E> &ctx, InputSection<E> &isec) {
       //
       // If the displacement is PC ± 128 MiB, we can use B or BL instead.
       // Note that $zero is $r0 and $ra is $r1.
-      if (i64 dist = compute_distance(ctx, sym, isec, r);
-          is_int(dist, 28))
-        if (u32 jirl = *(ul32 *)(buf + rels[i].r_offset + 4);
-            get_rd(jirl) == 0 || get_rd(jirl) == 1)
-          remove(4);
+      if (u32 jirl = *(ul32 *)(buf + rels[i].r_offset + 4);
+          get_rd(jirl) == 0 || get_rd(jirl) == 1) {
+        res.needs_rescan = true;
+        if (i64 dist = compute_distance(ctx, sym, isec, r); is_int(dist, 28))
+          nbytes = 4;
+      }
       break;
     case R_LARCH_GOT_PC_HI20:
       // The following two instructions are used to load a symbol address
@@ -1021,41 +1036,71 @@ void shrink_section(Context<E> &ctx, InputSection<E> &isec) {
       // relax them to the following instruction.
       //
       //   pcaddi    $t0, <offset>
-      if (is_relaxable_got_load(ctx, isec, i))
+      if (is_relaxable_got_load(ctx, isec, i)) {
+        res.needs_rescan = true;
         if (i64 dist = compute_distance(ctx, sym, isec, r);
             is_int(dist, 22) && (dist & 3) == 0)
-          remove(4);
+          nbytes = 4;
+      }
       break;
     case R_LARCH_TLS_DESC_PC_HI20:
       if (sym.has_tlsdesc(ctx)) {
-        u64 P = isec.get_addr() + r.r_offset;
+        res.needs_rescan = true;
+        u64 P = isec.get_addr() + r.r_offset - get_r_delta(isec, r.r_offset);
         i64 dist = sym.get_tlsdesc_addr(ctx) + r.r_addend - P;
         if (is_int(dist, 22))
-          remove(4);
+          nbytes = 4;
       } else {
-        remove(4);
+        nbytes = 4;
       }
       break;
     case R_LARCH_TLS_DESC_PC_LO12:
       if (!sym.has_tlsdesc(ctx))
-        remove(4);
+        nbytes = 4;
       break;
     case R_LARCH_TLS_DESC_LD:
       if (!sym.has_tlsdesc(ctx) && !sym.has_gottp(ctx))
         if (i64 val = sym.get_addr(ctx) + r.r_addend - ctx.tp_addr;
             0 <= val && val < 0x1000)
-          remove(4);
+          nbytes = 4;
       break;
     }
+
+    // A relaxation done by a previous pass is undone if it is no longer
+    // valid in the current layout.
+    i64 prev_nbytes = prev.get_removed_bytes(r.r_offset);
+    if (undo_only)
+      nbytes = std::min(nbytes, prev_nbytes);
+
+    if (nbytes > prev_nbytes) {
+      if (r.r_type == R_LARCH_CALL36)
+        counters.calls++;
+      else if (r.r_type == R_LARCH_PCALA_HI20)
+        counters.hi20++;
+    }
+
+    if (nbytes)
+      remove(nbytes);
   }
 
-  if (deltas.empty())
-    return;
+  // Update the section size and r_deltas. We reuse the existing array if
+  // possible because the same section may be shrunk more than once.
+  std::span<RelocDelta> &old = isec.extra.r_deltas;
+  res.changed = !ranges::equal(deltas, old);
+  if (!res.changed)
+    return res;
+
+  isec.sh_size += (old.empty() ? 0 : old.back().delta) - r_delta;
+
+  if (deltas.size() != old.size()) {
+    RelocDelta *p = nullptr;
+    if (!deltas.empty())
+      p = ctx.arena.template allocate<RelocDelta>(deltas.size());
+    old = {p, deltas.size()};
+  }
 
-  RelocDelta *p = ctx.arena.template allocate<RelocDelta>(deltas.size());
-  ranges::copy(deltas, p);
-  isec.extra.r_deltas = {p, deltas.size()};
-  isec.sh_size -= r_delta;
+  ranges::copy(deltas, old.begin());
+  return res;
 }
 
 } // namespace mold
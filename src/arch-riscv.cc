@@ -334,19 +334,25 @@ void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
       i64 val = S + A - P;
       i64 rd = get_rd(buf + rel.r_offset + 4);
 
+      // shrink_sections() is supposed to relax a call only if the target
+      // is in range in the final layout, but we check it just in case
+      // so that we never silently write a wrong displacement.
       if (removed_bytes == 4) {
         // auipc + jalr -> jal
+        check(val, -(1 << 20), 1 << 20);
         *(ul32 *)loc = (rd << 7) | 0b1101111;
         write_jtype(loc, val);
         rewrite(i, R_RISCV_JAL);
       } else if (removed_bytes == 6 && rd == 0) {
         // auipc + jalr -> c.j
+        check(val, -(1 << 11), 1 << 11);
         *(ul16 *)loc = 0b101'00000000000'01;
         write_cjtype(loc, val);
         rewrite(i, R_RISCV_RVC_JUMP);
       } else if (removed_bytes == 6 && rd == 1) {
         // auipc + jalr -> c.jal
         assert(!E::is_64);
+        check(val, -(1 << 11), 1 << 11);
         *(ul16 *)loc = 0b001'00000000000'01;
         write_cjtype(loc, val);
         rewrite(i, R_RISCV_RVC_JUMP);
@@ -443,10 +449,13 @@ void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
       // (removed 4 bytes); either way it no longer needs a relocation.
       if (removed_bytes == 2) {
         // Rewrite LUI with C.LUI
+        check(S + A + 0x800, -(1 << 17), 1 << 17);
         i64 rd = get_rd(buf + rel.r_offset);
         *(ul16 *)loc = 0b011'0'00000'00000'01 | (rd << 7);
         write_citype(loc, (S + A + 0x800) >> 12);
-      } else if (removed_bytes == 0) {
+      } else if (removed_bytes == 4) {
+        check(S + A, -(1 << 11), 1 << 11);
+      } else {
         utype(S + A);
       }
       if (removed_bytes)
@@ -883,13 +892,18 @@ u64 get_eflags(Context<E> &ctx) {
   return ret;
 }
 
-// Scan relocations to shrink a given section.
+// Scan relocations to shrink a given section. If `undo_only` is true,
+// we don't relax relocations further but only undo relaxations that are
+// no longer valid.
 template <>
-void shrink_section(Context<E> &ctx, InputSection<E> &isec) {
+ShrinkResult shrink_section(Context<E> &ctx, InputSection<E> &isec,
+                            RelaxCounters &counters, bool undo_only) {
   std::span<const ElfRel<E>> rels = isec.get_rels(ctx);
+  RelocDeltaCursor prev(isec.extra.r_deltas);
   std::vector<RelocDelta> deltas;
   i64 r_delta = 0;
   u8 *buf = isec.contents;
+  ShrinkResult res;
 
   // True if we can use 2-byte instructions. This is usually true on
   // Unix because RV64GC is generally considered the baseline hardware.
@@ -911,9 +925,11 @@ void shrink_section(Context<E> &ctx, InputSection<E> &isec) {
     // follows the NOPs is aligned to a specified alignment boundary.
     if (r.r_type == R_RISCV_ALIGN) {
       // The total bytes of NOPs is stored to r_addend, so the next
-      // instruction is r_addend away.
+      // instruction is r_addend away. r_addend is the alignment minus
+      // the size of the shortest instruction, which is 2 with the C
+      // extension and 4 without it.
       u64 P = isec.get_addr() + r.r_offset - r_delta;
-      u64 desired = align_to(P, bit_ceil(r.r_addend));
+      u64 desired = align_to(P, bit_ceil(r.r_addend + 2));
       u64 actual = P + r.r_addend;
       if (desired != actual)
         remove(actual - desired);
@@ -933,29 +949,32 @@ void shrink_section(Context<E> &ctx, InputSection<E> &isec) {
     if (sym.file == ctx.internal_obj)
       continue;
 
+    // The number of bytes we can remove at this relocation
+    i64 nbytes = 0;
+
     switch (r.r_type) {
     case R_RISCV_CALL:
     case R_RISCV_CALL_PLT: {
       // These relocations refer to an AUIPC + JALR instruction pair to
       // allow to jump to anywhere in PC ± 2 GiB. If the jump target is
       // close enough to PC, we can use C.J, C.JAL or JAL instead.
+      res.needs_rescan = true;
+
       i64 dist = compute_distance(ctx, sym, isec, r);
       if (dist & 1)
         break;
 
       i64 rd = get_rd(buf + r.r_offset + 4);
+      bool is_c_jump = use_rvc && (rd == 0 || (!E::is_64 && rd == 1));
 
-      if (use_rvc && rd == 0 && is_int(dist, 12)) {
+      if (is_c_jump && is_int(dist, 12)) {
         // If rd is x0 and the jump target is within ±2 KiB, we can use
-        // C.J, saving 6 bytes.
-        remove(6);
-      } else if (use_rvc && !E::is_64 && rd == 1 && is_int(dist, 12)) {
-        // If rd is x1 and the jump target is within ±2 KiB, we can use
-        // C.JAL. This is RV32 only because C.JAL is RV32-only instruction.
-        remove(6);
+        // C.J, saving 6 bytes. If rd is x1, we can use C.JAL likewise.
+        // This is RV32 only because C.JAL is RV32-only instruction.
+        nbytes = 6;
       } else if (is_int(dist, 21)) {
         // If the jump target is within ±1 MiB, we can use JAL.
-        remove(4);
+        nbytes = 4;
       }
       break;
     }
@@ -968,10 +987,10 @@ void shrink_section(Context<E> &ctx, InputSection<E> &isec) {
         u64 val = sym.get_addr(ctx) + r.r_addend;
         if (use_rvc && is_int(val, 6) && get_rd(buf + r.r_offset) != 0) {
           // Replace AUIPC + LD with C.LI.
-          remove(6);
+          nbytes = 6;
         } else if (is_int(val, 12)) {
           // Replace AUIPC + LD with ADDI.
-          remove(4);
+          nbytes = 4;
         }
       }
       break;
@@ -983,12 +1002,15 @@ void shrink_section(Context<E> &ctx, InputSection<E> &isec) {
         // We can replace `lui t0, %hi(foo)` and `add t0, t0, %lo(foo)`
         // instruction pair with `add t0, x0, %lo(foo)` if foo's bits
         // [32:11] are all one or all zero.
-        remove(4);
+        nbytes = 4;
       } else if (use_rvc && rd != 0 && rd != 2 && is_int(val + 0x800, 18)) {
         // If the upper 20 bits can actually be represented in 6 bits,
         // we can use C.LUI instead of LUI.
-        remove(2);
+        nbytes = 2;
       }
+
+      if (!sym.is_absolute())
+        res.needs_rescan = true;
       break;
     }
     case R_RISCV_TPREL_HI20:
@@ -1014,11 +1036,11 @@ void shrink_section(Context<E> &ctx, InputSection<E> &isec) {
       // Here, we remove `lui` and `add` if the offset is within ±2 KiB.
       if (i64 val = sym.get_addr(ctx) + r.r_addend - ctx.tp_addr;
           is_int(val, 12))
-        remove(4);
+        nbytes = 4;
       break;
     case R_RISCV_TLSDESC_HI20:
       if (!sym.has_tlsdesc(ctx))
-        remove(4);
+        nbytes = 4;
       break;
     case R_RISCV_TLSDESC_LOAD_LO12:
     case R_RISCV_TLSDESC_ADD_LO12: {
@@ -1027,26 +1049,53 @@ void shrink_section(Context<E> &ctx, InputSection<E> &isec) {
 
       if (r.r_type == R_RISCV_TLSDESC_LOAD_LO12) {
         if (!sym2.has_tlsdesc(ctx))
-          remove(4);
+          nbytes = 4;
       } else {
         assert(r.r_type == R_RISCV_TLSDESC_ADD_LO12);
         if (!sym2.has_tlsdesc(ctx) && !sym2.has_gottp(ctx))
           if (i64 val = sym2.get_addr(ctx) + rel2.r_addend - ctx.tp_addr;
               is_int(val, 12))
-            remove(4);
+            nbytes = 4;
       }
       break;
     }
     }
+
+    // A relaxation done by a previous pass is undone if it is no longer
+    // valid in the current layout.
+    i64 prev_nbytes = prev.get_removed_bytes(r.r_offset);
+    if (undo_only)
+      nbytes = std::min(nbytes, prev_nbytes);
+
+    if (nbytes > prev_nbytes) {
+      if (r.r_type == R_RISCV_CALL || r.r_type == R_RISCV_CALL_PLT)
+        counters.calls++;
+      else if (r.r_type == R_RISCV_HI20)
+        counters.hi20++;
+    }
+
+    if (nbytes)
+      remove(nbytes);
   }
 
-  if (deltas.empty())
-    return;
+  // Update the section size and r_deltas. We reuse the existing array if
+  // possible because the same section may be shrunk more than once.
+  std::span<RelocDelta> &old = isec.extra.r_deltas;
+  res.changed = !ranges::equal(deltas, old);
+  if (!res.changed)
+    return res;
+
+  isec.sh_size += (old.empty() ? 0 : old.back().delta) - r_delta;
+
+  if (deltas.size() != old.size()) {
+    RelocDelta *p = nullptr;
+    if (!deltas.empty())
+      p = ctx.arena.template allocate<RelocDelta>(deltas.size());
+    old = {p, deltas.size()};
+  }
 
-  RelocDelta *p = ctx.arena.template allocate<RelocDelta>(deltas.size());
-  ranges::copy(deltas, p);
-  isec.extra.r_deltas = {p, deltas.size()};
-  isec.sh_size -= r_delta;
+  ranges::copy(deltas, old.begin());
+  return res;
 }
 
 // ISA name handlers
@@ -428,15 +428,85 @@ static void relax_ld_to_le(u8 *loc, const ElfRel<E> &rel, i64 tls_size) {
   }
 }
 
+// scan_relocations() classifies each relocation into one of the
+// following actions. Frequently-used relocations whose handling is
+// fully determined at scan time get their own action so that
+// apply_reloc_alloc() can skip symbol type checks, GOT address
+// computation and instruction pattern matching. Everything else is
+// ACT_DECODE and handled by the regular switch.
+enum : u8 {
+  ACT_DECODE,
+  ACT_SKIP,
+  ACT_ABS32,
+  ACT_ABS32S,
+  ACT_PC32,
+  ACT_GOTPCREL,
+  ACT_GOTTPOFF,
+};
+
+// We keep at most this many actions in total to bound the memory usage.
+// Sections beyond the limit are decoded twice.
+static constexpr i64 MAX_RELOC_ACTIONS = 1LL << 28;
+
 // Apply relocations to SHF_ALLOC sections (i.e. sections that are
 // mapped to memory at runtime) based on the result of
 // scan_relocations().
 template <>
 void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
   std::span<ElfRel<E>> rels = get_rels(ctx);
+  u8 *actions = extra.reloc_actions;
+
+  // All GOTPCRELX outcomes are counted here rather than in
+  // scan_relocations() so that each relocation is counted exactly once.
+  static Counter gotpcrelx_relaxed("gotpcrelx_relaxed");
+  static Counter gotpcrelx_norelax_insn("gotpcrelx_norelax_insn");
+  static Counter gotpcrelx_norelax_dyn("gotpcrelx_norelax_dyn");
+  static Counter gotpcrelx_norelax_range("gotpcrelx_norelax_range");
 
   for (i64 i = 0; i < rels.size(); i++) {
     ElfRel<E> &rel = rels[i];
+
+    if (actions && actions[i] != ACT_DECODE) {
+      if (actions[i] == ACT_SKIP)
+        continue;
+
+      Symbol<E> &sym = *file->symbols[rel.r_sym];
+      u8 *loc = base + rel.r_offset;
+      u64 A = rel.r_addend;
+      u64 P = get_addr() + rel.r_offset;
+      i64 val;
+
+      switch (actions[i]) {
+      case ACT_ABS32:
+        val = sym.get_addr(ctx) + A;
+        check_range(ctx, i, val, 0, 1LL << 32);
+        break;
+      case ACT_ABS32S:
+        val = sym.get_addr(ctx) + A;
+        check_range(ctx, i, val, -(1LL << 31), 1LL << 31);
+        break;
+      case ACT_PC32:
+        val = sym.get_addr(ctx) + A - P;
+        check_range(ctx, i, val, -(1LL << 31), 1LL << 31);
+        break;
+      case ACT_GOTPCREL:
+        if (rel.r_type != R_X86_64_GOTPCREL)
+          gotpcrelx_norelax_insn++;
+        val = sym.get_got_addr(ctx) + A - P;
+        check_range(ctx, i, val, -(1LL << 31), 1LL << 31);
+        break;
+      case ACT_GOTTPOFF:
+        val = sym.get_gottp_addr(ctx) + A - P;
+        check_range(ctx, i, val, -(1LL << 31), 1LL << 31);
+        break;
+      default:
+        unreachable();
+      }
+
+      *(ul32 *)loc = val;
+      continue;
+    }
+
     if (rel.r_type == R_NONE)
       continue;
 
@@ -526,15 +596,20 @@ void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
       // We always want to relax GOTPCRELX relocs even if --no-relax
       // was given because some static PIE runtime code depends on these
       // relaxations.
-      if (sym.is_pcrel_linktime_const(ctx) && is_int(S + A - P, 32)) {
-        if (u32 insn = relax_gotpcrelx(loc, rel)) {
-          loc[-2] = insn >> 8;
-          loc[-1] = insn;
-          *(ul32 *)loc = S + A - P;
-          if (ctx.arg.emit_relocs)
-            rel.r_type = R_X86_64_PC32;
-          break;
-        }
+      if (u32 insn = relax_gotpcrelx(loc, rel); !insn) {
+        gotpcrelx_norelax_insn++;
+      } else if (!sym.is_pcrel_linktime_const(ctx)) {
+        gotpcrelx_norelax_dyn++;
+      } else if (!is_int(S + A - P, 32)) {
+        gotpcrelx_norelax_range++;
+      } else {
+        loc[-2] = insn >> 8;
+        loc[-1] = insn;
+        *(ul32 *)loc = S + A - P;
+        if (ctx.arg.emit_relocs)
+          rel.r_type = R_X86_64_PC32;
+        gotpcrelx_relaxed++;
+        break;
       }
       write32s(G + GOT + A - P);
       break;
@@ -756,15 +831,50 @@ void InputSection<E>::scan_relocations(Context<E> &ctx) {
   assert(shdr().sh_flags & SHF_ALLOC);
   std::span<const ElfRel<E>> rels = get_rels(ctx);
 
+  // Allocate an action array unless we have already allocated too many.
+  // A zero-filled array means ACT_DECODE for all relocations.
+  u8 *actions = nullptr;
+  if (!rels.empty() &&
+      ctx.extra.num_reloc_actions.fetch_add(rels.size()) + rels.size() <=
+      MAX_RELOC_ACTIONS) {
+    actions = ctx.arena.template allocate<u8>(rels.size());
+    memset(actions, ACT_DECODE, rels.size());
+  }
+
+  static Counter tlsgd_to_le("tlsgd_to_le");
+  static Counter tlsgd_to_ie("tlsgd_to_ie");
+  static Counter tlsgd_norelax("tlsgd_norelax");
+  static Counter tlsld_to_le("tlsld_to_le");
+  static Counter tlsld_norelax("tlsld_norelax");
+  static Counter gottpoff_to_le("gottpoff_to_le");
+  static Counter gottpoff_norelax("gottpoff_norelax");
+  extra.reloc_actions = actions;
+
   // Scan relocations
   for (i64 i = 0; i < rels.size(); i++) {
     const ElfRel<E> &rel = rels[i];
-    if (rel.r_type == R_NONE || record_undef_error(ctx, rel))
+
+    if (rel.r_type == R_NONE) {
+      if (actions)
+        actions[i] = ACT_SKIP;
+      continue;
+    }
+
+    if (record_undef_error(ctx, rel))
       continue;
 
     Symbol<E> &sym = *file->symbols[rel.r_sym];
     u8 *loc = contents + rel.r_offset;
 
+    // Record what apply_reloc_alloc() has to do for this relocation.
+    // Relocations against remaining undefined weak TLS symbols are
+    // handled specially, so we always decode them.
+    auto set_action = [&](u8 act) {
+      if (actions &&
+          (sym.get_type() != STT_TLS || !sym.is_remaining_undef_weak()))
+        actions[i] = act;
+    };
+
     if (sym.is_ifunc())
       sym.flags |= NEEDS_GOT | NEEDS_PLT;
 
@@ -784,28 +894,51 @@ void InputSection<E>::scan_relocations(Context<E> &ctx) {
     switch (rel.r_type) {
     case R_X86_64_8:
     case R_X86_64_16:
+      scan_absrel(ctx, sym, rel);
+      break;
     case R_X86_64_32:
+      scan_absrel(ctx, sym, rel);
+      set_action(ACT_ABS32);
+      break;
     case R_X86_64_32S:
       scan_absrel(ctx, sym, rel);
+      set_action(ACT_ABS32S);
       break;
     case R_X86_64_PC8:
     case R_X86_64_PC16:
-    case R_X86_64_PC32:
     case R_X86_64_PC64:
       scan_pcrel(ctx, sym, rel);
       break;
+    case R_X86_64_PC32:
+      scan_pcrel(ctx, sym, rel);
+      set_action(ACT_PC32);
+      break;
     case R_X86_64_GOT32:
     case R_X86_64_GOT64:
     case R_X86_64_GOTPC32:
     case R_X86_64_GOTPC64:
-    case R_X86_64_GOTPCREL:
     case R_X86_64_GOTPCREL64:
+      sym.flags |= NEEDS_GOT;
+      break;
+    case R_X86_64_GOTPCREL:
+      sym.flags |= NEEDS_GOT;
+      set_action(ACT_GOTPCREL);
+      break;
     case R_X86_64_GOTPCRELX:
     case R_X86_64_REX_GOTPCRELX:
     case R_X86_64_CODE_4_GOTPCRELX:
+      // Whether or not the relocation is relaxed depends on the final
+      // symbol address, but if the instruction is not relaxable, we
+      // know the answer now.
       sym.flags |= NEEDS_GOT;
+      if (!relax_gotpcrelx(loc, rel))
+        set_action(ACT_GOTPCREL);
       break;
     case R_X86_64_PLT32:
+      if (sym.is_imported)
+        sym.flags |= NEEDS_PLT;
+      set_action(ACT_PC32);
+      break;
     case R_X86_64_PLTOFF64:
       if (sym.is_imported)
         sym.flags |= NEEDS_PLT;
@@ -814,30 +947,42 @@ void InputSection<E>::scan_relocations(Context<E> &ctx) {
       if (ctx.arg.static_ || (ctx.arg.relax && sym.is_tprel_linktime_const(ctx))) {
         // We always relax if -static because libc.a doesn't contain
         // __tls_get_addr().
+        tlsgd_to_le++;
         i++;
       } else if (ctx.arg.relax && sym.is_tprel_runtime_const(ctx)) {
         sym.flags |= NEEDS_GOTTP;
+        tlsgd_to_ie++;
         i++;
       } else {
         sym.flags |= NEEDS_TLSGD;
+        tlsgd_norelax++;
       }
       break;
     case R_X86_64_TLSLD:
       // We always relax if -static because libc.a doesn't contain
       // __tls_get_addr().
-      if (ctx.arg.static_ || (ctx.arg.relax && !ctx.arg.shared))
+      if (ctx.arg.static_ || (ctx.arg.relax && !ctx.arg.shared)) {
+        tlsld_to_le++;
         i++;
-      else
+      } else {
         ctx.needs_tlsld = true;
+        tlsld_norelax++;
+      }
       break;
     case R_X86_64_GOTTPOFF:
     case R_X86_64_CODE_4_GOTTPOFF:
       if (!ctx.arg.relax || !sym.is_tprel_linktime_const(ctx) ||
-          !relax_gottpoff(loc, rel))
+          !relax_gottpoff(loc, rel)) {
         sym.flags |= NEEDS_GOTTP;
+        set_action(ACT_GOTTPOFF);
+        gottpoff_norelax++;
+      } else {
+        gottpoff_to_le++;
+      }
       break;
     case R_X86_64_CODE_6_GOTTPOFF:
       sym.flags |= NEEDS_GOTTP;
+      set_action(ACT_GOTTPOFF);
       break;
     case R_X86_64_TLSDESC_CALL:
       scan_tlsdesc(ctx, sym);
@@ -847,6 +992,11 @@ void InputSection<E>::scan_relocations(Context<E> &ctx) {
       check_tlsle(ctx, sym, rel);
       break;
     case R_X86_64_64:
+      // Word-size absolute relocations are applied by
+      // OutputSection::scan_abs_relocations() and its friends.
+      if (actions)
+        actions[i] = ACT_SKIP;
+      break;
     case R_X86_64_GOTOFF64:
     case R_X86_64_DTPOFF32:
     case R_X86_64_DTPOFF64:
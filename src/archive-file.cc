@@ -174,6 +174,93 @@ read_archive_members(Context<E> &ctx, MappedFile *mf) {
   return read_thin_archive_members(ctx, mf);
 }
 
+// Reads the archive symbol table, i.e. the "/" or "/SYM64/" member that
+// `ar s` creates. It maps each global symbol name to the member defining
+// it. Members are identified by their indices in the vector that
+// read_archive_members() returns. Returns std::nullopt if the archive has
+// no usable symbol table.
+template <typename E>
+std::optional<std::vector<std::pair<std::string_view, i64>>>
+read_archive_symtab(Context<E> &ctx, MappedFile *mf) {
+  u8 *begin = mf->data;
+  u8 *data = begin + 8;
+  bool is_thin = mf->get_contents().starts_with("!<thin>\n");
+  std::string_view strtab;
+  std::string_view symtab;
+  bool is_64 = false;
+
+  // The symbol table refers to members by their header offsets.
+  std::unordered_map<u64, i64> members;
+
+  while (begin + mf->size - data >= (i64)sizeof(ArHdr)) {
+    if ((begin - data) % 2)
+      data++;
+
+    ArHdr &hdr = *(ArHdr *)data;
+    u8 *body = data + sizeof(hdr);
+    u64 size = atol(hdr.ar_size);
+    u64 offset = data - begin;
+
+    // A thin archive member's contents are in a separate file.
+    data = body + size;
+
+    if (hdr.is_strtab()) {
+      strtab = {(char *)body, (size_t)size};
+      continue;
+    }
+
+    if (hdr.is_symtab()) {
+      if (symtab.empty()) {
+        symtab = {(char *)body, (size_t)size};
+        is_64 = hdr.starts_with("/SYM64/");
+      }
+      continue;
+    }
+
+    if (is_thin)
+      data = body;
+
+    std::string name = hdr.read_name(strtab, body);
+    if (name == "__.SYMDEF" || name == "__.SYMDEF SORTED")
+      continue;
+    members.insert({offset, members.size()});
+  }
+
+  if (symtab.empty())
+    return {};
+
+  // The table consists of the number of symbols, big-endian offsets of
+  // their member headers, and NUL-terminated symbol names.
+  i64 word = is_64 ? 8 : 4;
+  auto read_word = [&](i64 pos) -> u64 {
+    if (is_64)
+      return *(ub64 *)(symtab.data() + pos);
+    return *(ub32 *)(symtab.data() + pos);
+  };
+
+  if (symtab.size() < word)
+    return {};
+
+  u64 num_syms = read_word(0);
+  if (num_syms > (symtab.size() - word) / word)
+    return {};
+
+  std::string_view names = symtab.substr(word + num_syms * word);
+  std::vector<std::pair<std::string_view, i64>> vec;
+  vec.reserve(num_syms);
+
+  for (i64 i = 0; i < num_syms; i++) {
+    auto it = members.find(read_word(word + i * word));
+    size_t len = names.find('\0');
+    if (it == members.end() || len == names.npos)
+      return {};
+
+    vec.push_back({names.substr(0, len), it->second});
+    names = names.substr(len + 1);
+  }
+  return vec;
+}
+
 using E = MOLD_TARGET;
 
 template std::vector<MappedFile *>
@@ -185,4 +272,7 @@ read_fat_archive_members(Context<E> &, MappedFile *);
 template std::vector<MappedFile *>
 read_archive_members(Context<E> &, MappedFile *);
 
+template std::optional<std::vector<std::pair<std::string_view, i64>>>
+read_archive_symtab(Context<E> &, MappedFile *);
+
 } // namespace mold
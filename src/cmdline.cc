@@ -120,14 +120,19 @@ Options:
   --gc-sections               Remove unreferenced sections
     --no-gc-sections
   --gdb-index                 Create .gdb_index for faster gdb startup
+  --hash-bloom-bits NUMBER    Set bloom filter bits per symbol in .gnu.hash (default: 12)
+  --hash-load-factor NUMBER   Set average number of symbols per .gnu.hash bucket (default: 8)
   --hash-style [sysv,gnu,both,none]
                               Set hash style
+  --hot-data-file FILE        Place data objects listed in FILE close together
   --icf=[all,safe,none]       Fold identical code
     --no-icf
   --ignore-data-address-equality
                               Allow merging non-executable sections with --icf
   --image-base ADDR           Set the base address to a given value
   --init SYMBOL               Call SYMBOL at load-time
+  --lazy-archives             Read archive members only when they are needed
+    --no-lazy-archives
   --nmagic                    Do not page align sections
     --no-nmagic
   --no-undefined              Report undefined symbols (even with --shared)
@@ -145,6 +150,9 @@ Options:
     --no-print-gc-sections
   --print-icf-sections[=FILE] Print, or save in FILE, folded identical sections
     --no-print-icf-sections
+  --print-sframe-failures[=FILE]
+                              Print, or save in FILE, FDEs --synthesize-sframe couldn't convert
+    --no-print-sframe-failures
   --push-state                Save the state of flags governing input file handling
   --quick-exit                Use quick_exit to exit (default)
     --no-quick-exit
@@ -172,7 +180,12 @@ Options:
   --start-lib                 Give following object files in-archive-file semantics
     --end-lib                 End the effect of --start-lib
   --stats                     Print input statistics
+  --synthesize-sframe         Create .sframe from .eh_frame for objects lacking it
+    --no-synthesize-sframe
   --sysroot DIR               Set the target system root directory
+  --tail-merge-strings[=MAX_LENGTH]
+                              Store strings that are suffixes of other strings in them
+    --no-tail-merge-strings
   --thread-count COUNT, --threads=COUNT
                               Use COUNT number of threads
   --threads                   Use multiple threads (default)
@@ -200,9 +213,12 @@ Options:
   -z defs                     Report undefined symbols (even with --shared)
     -z nodefs
   -z common-page-size=VALUE   Ignored
+  -z crel                     Use CREL for --relocatable and --emit-relocs relocation sections
+    -z nocrel
   -z execstack                Require an executable stack
     -z noexecstack
   -z execstack-if-needed      Make the stack area executable if an input file explicitly requests it
+  -z hugepage-text            Place .text in its own segment aligned to 2 MiB huge pages
   -z initfirst                Mark DSO to be initialized first at runtime
   -z interpose                Mark object to interpose all DSOs but the executable
   -z keep-text-section-prefix Keep .text.{hot,unknown,unlikely,startup,exit} as separate sections in the final binary
@@ -525,6 +541,45 @@ static void read_retain_symbols_file(Context<E> &ctx, std::string_view path) {
   ctx.arg.retain_symbols_file = std::move(vec);
 }
 
+template <typename E>
+static void read_hot_data_file(Context<E> &ctx, std::string_view path) {
+  MappedFile *mf = must_open_file(ctx, std::string(path));
+  std::string_view data((char *)mf->data, mf->size);
+
+  while (!data.empty()) {
+    size_t pos = data.find('\n');
+    std::string_view line;
+
+    if (pos == data.npos) {
+      line = data;
+      data = "";
+    } else {
+      line = data.substr(0, pos);
+      data = data.substr(pos + 1);
+    }
+
+    if (size_t i = line.find('#'); i != line.npos)
+      line = line.substr(0, i);
+
+    line = string_trim(line);
+    if (line.empty())
+      continue;
+
+    std::string_view name = line;
+    bool is_write_hot = false;
+
+    if (size_t i = line.find_first_of(" \t"); i != line.npos) {
+      name = line.substr(0, i);
+      std::string_view attr = string_trim(line.substr(i));
+      if (attr != "write")
+        Fatal(ctx) << path << ": unknown attribute: " << attr;
+      is_write_hot = true;
+    }
+
+    ctx.arg.hot_data_symbols.push_back({get_symbol(ctx, name), is_write_hot});
+  }
+}
+
 static bool is_file(const std::filesystem::path& path) {
   std::error_code error;
   return !std::filesystem::is_directory(path, error) && !error;
@@ -981,6 +1036,14 @@ std::vector<ReaderJob> parse_nonpositional_args(Context<E> &ctx) {
       ctx.arg.init = get_symbol(ctx, arg);
     } else if (read_arg("fini")) {
       ctx.arg.fini = get_symbol(ctx, arg);
+    } else if (read_arg("hash-bloom-bits")) {
+      ctx.arg.hash_bloom_bits = parse_number(ctx, "hash-bloom-bits", arg);
+      if (ctx.arg.hash_bloom_bits <= 0)
+        Fatal(ctx) << "invalid --hash-bloom-bits argument: " << arg;
+    } else if (read_arg("hash-load-factor")) {
+      ctx.arg.hash_load_factor = parse_number(ctx, "hash-load-factor", arg);
+      if (ctx.arg.hash_load_factor <= 0)
+        Fatal(ctx) << "invalid --hash-load-factor argument: " << arg;
     } else if (read_arg("hash-style")) {
       if (arg == "sysv") {
         ctx.arg.hash_style_sysv = true;
@@ -997,6 +1060,8 @@ std::vector<ReaderJob> parse_nonpositional_args(Context<E> &ctx) {
       } else {
         Fatal(ctx) << "invalid --hash-style argument: " << arg;
       }
+    } else if (read_arg("hot-data-file")) {
+      read_hot_data_file(ctx, arg);
     } else if (read_arg("soname") || read_arg("h")) {
       ctx.arg.soname = arg;
     } else if (read_arg("audit")) {
@@ -1065,6 +1130,17 @@ std::vector<ReaderJob> parse_nonpositional_args(Context<E> &ctx) {
     } else if (read_flag("stats")) {
       ctx.arg.stats = true;
       Counter::enabled = true;
+    } else if (read_flag("synthesize-sframe")) {
+      ctx.arg.synthesize_sframe = true;
+    } else if (read_flag("no-synthesize-sframe")) {
+      ctx.arg.synthesize_sframe = false;
+    } else if (read_flag("tail-merge-strings")) {
+      ctx.arg.tail_merge_strings = 1024;
+    } else if (read_eq("tail-merge-strings")) {
+      ctx.arg.tail_merge_strings =
+        parse_number(ctx, "tail-merge-strings", arg);
+    } else if (read_flag("no-tail-merge-strings")) {
+      ctx.arg.tail_merge_strings = 0;
     } else if (read_arg("C") || read_arg("directory")) {
       ctx.arg.directory = arg;
     } else if (read_arg("chroot")) {
@@ -1208,6 +1284,8 @@ std::vector<ReaderJob> parse_nonpositional_args(Context<E> &ctx) {
     } else if (read_z_flag("ibtplt")) {
     } else if (read_z_flag("muldefs")) {
       ctx.arg.allow_multiple_definition = true;
+    } else if (read_z_flag("hugepage-text")) {
+      ctx.arg.z_hugepage_text = true;
     } else if (read_z_flag("keep-text-section-prefix")) {
       ctx.arg.z_keep_text_section_prefix = true;
     } else if (read_z_flag("nokeep-text-section-prefix")) {
@@ -1244,6 +1322,10 @@ std::vector<ReaderJob> parse_nonpositional_args(Context<E> &ctx) {
       ctx.arg.z_sectionheader = true;
     } else if (read_z_flag("nosectionheader")) {
       ctx.arg.z_sectionheader = false;
+    } else if (read_z_flag("crel")) {
+      ctx.arg.z_crel = true;
+    } else if (read_z_flag("nocrel")) {
+      ctx.arg.z_crel = false;
     } else if (read_z_flag("rodynamic")) {
       ctx.arg.z_rodynamic = true;
     } else if (read_z_flag("x86-64-v2")) {
@@ -1272,6 +1354,10 @@ std::vector<ReaderJob> parse_nonpositional_args(Context<E> &ctx) {
       ctx.arg.fork = true;
     } else if (read_flag("no-fork")) {
       ctx.arg.fork = false;
+    } else if (read_flag("lazy-archives")) {
+      ctx.arg.lazy_archives = true;
+    } else if (read_flag("no-lazy-archives")) {
+      ctx.arg.lazy_archives = false;
     } else if (read_flag("gc-sections")) {
       ctx.arg.gc_sections = true;
     } else if (read_flag("no-gc-sections")) {
@@ -1311,6 +1397,12 @@ std::vector<ReaderJob> parse_nonpositional_args(Context<E> &ctx) {
       ctx.arg.print_icf_sections = arg;
     } else if (read_flag("no-print-icf-sections")) {
       ctx.arg.print_icf_sections = "";
+    } else if (read_flag("print-sframe-failures")) {
+      ctx.arg.print_sframe_failures = "-";
+    } else if (read_eq("print-sframe-failures")) {
+      ctx.arg.print_sframe_failures = arg;
+    } else if (read_flag("no-print-sframe-failures")) {
+      ctx.arg.print_sframe_failures = "";
     } else if (read_flag("quick-exit")) {
       ctx.arg.quick_exit = true;
     } else if (read_flag("no-quick-exit")) {
@@ -1666,6 +1758,11 @@ std::vector<ReaderJob> parse_nonpositional_args(Context<E> &ctx) {
     if (ctx.arg.apply_dynamic_relocs)
       Fatal(ctx) << "--apply-dynamic-relocs may not be used on SPARC64";
 
+  // We write CREL only for RELA-type targets.
+  if constexpr (!E::is_rela)
+    if (ctx.arg.z_crel)
+      Fatal(ctx) << "-z crel may not be used on " << E::name;
+
   if (!ctx.arg.section_start.empty() && !ctx.arg.section_order.empty())
     Fatal(ctx) << "--section-start may not be used with --section-order";
 
@@ -645,9 +645,11 @@ static void parse_fde_encoding(Context<E> &ctx, CieRecord<E> &cie) {
 //   coverage starts at the .text address] to make binary search doable.
 //   In order to create .eh_frame_hdr, linker has to read .eh_frame.
 //
-// This function parses an input .eh_frame section.
+// This function reads CIEs and FDEs from input .eh_frame sections.
+// It doesn't depend on section liveness, so it may be called before
+// LTO to overlap the work with code generation.
 template <typename E>
-void ObjectFile<E>::parse_ehframe(Context<E> &ctx) {
+void ObjectFile<E>::read_ehframe_records(Context<E> &ctx) {
   for (InputSection<E> *isec : eh_frame_sections) {
     std::span<ElfRel<E>> rels = isec->get_rels(ctx);
     i64 cies_begin = cies.size();
@@ -712,6 +714,15 @@ void ObjectFile<E>::parse_ehframe(Context<E> &ctx) {
     isec->kill();
   }
 
+  eh_frame_sections.clear();
+}
+
+// This function parses input .eh_frame sections and associates FDEs
+// with live input sections.
+template <typename E>
+void ObjectFile<E>::parse_ehframe(Context<E> &ctx) {
+  read_ehframe_records(ctx);
+
   auto get_isec = [&](const FdeRecord<E> &fde) {
     return get_section(this->elf_syms[fde.get_rels(*this)[0].r_sym]);
   };
@@ -832,6 +843,405 @@ void ObjectFile<E>::parse_sframe(Context<E> &ctx) requires supports_sframe<E> {
       sframe_fdes.push_back(fde);
     }
   }
+
+  sframe_sections.clear();
+}
+
+// The subset of a DWARF CFI table row that SFrame can describe: how to
+// compute the CFA and where, relative to the CFA, the frame pointer and
+// the return address are saved.
+struct CfiRow {
+  bool operator==(const CfiRow &) const = default;
+
+  i64 cfa_reg = -1;
+  i64 cfa_offset = 0;
+  std::optional<i64> fp_offset;
+  std::optional<i64> ra_offset;
+  bool ra_mangled = false;
+};
+
+// Converts an .eh_frame FDE to an SFrame FRE block by interpreting its
+// CFA program and the initial instructions of its CIE. We handle only
+// the common instructions that define the CFA as SP or FP plus an
+// offset and save FP and RA on the stack. If the FDE uses anything
+// else, the FDE can't be expressed in SFrame, and we return a string
+// describing the reason. On success, we return an empty string.
+template <typename E>
+static std::string_view
+eh_frame_to_sframe(ObjectFile<E> &file, FdeRecord<E> &fde, std::string &out,
+                   i64 &num_fres) requires is_x86_64<E> || is_arm64<E> {
+  // DWARF register numbers of the registers that SFrame cares about.
+  constexpr i64 sp_reg = is_x86_64<E> ? 7 : 31;
+  constexpr i64 fp_reg = is_x86_64<E> ? 6 : 29;
+  constexpr i64 ra_reg = is_x86_64<E> ? 16 : 30;
+
+  CieRecord<E> &cie = file.cies[fde.cie_idx];
+
+  // Parse the CIE header.
+  std::string_view data = cie.get_contents();
+  u8 version = data[8];
+  std::string_view aug = data.data() + 9;
+  u8 *p = (u8 *)data.data() + 9 + aug.size() + 1;
+  u8 *end = (u8 *)data.data() + data.size();
+
+  u64 code_align = read_uleb(&p);
+  i64 data_align = read_sleb(&p);
+  u64 ra = (version == 1) ? *p++ : read_uleb(&p);
+  if (ra != ra_reg)
+    return "unsupported return address register";
+
+  bool pauth_key_b = false;
+  if (aug.starts_with('z')) {
+    if (aug.find('S') != aug.npos)
+      return "signal frame";
+    pauth_key_b = aug.find('B') != aug.npos;
+    u64 len = read_uleb(&p);
+    p += len;
+  }
+
+  std::string_view cie_insns = {(char *)p, (size_t)(end - p)};
+
+  // Parse the FDE header.
+  data = fde.get_contents(file);
+  i64 ptr_size = cie.fde_ptr_size;
+  p = (u8 *)data.data() + 8 + ptr_size;
+  end = (u8 *)data.data() + data.size();
+
+  u64 func_size = (ptr_size == 4) ? (u64)*(U32<E> *)p : (u64)*(U64<E> *)p;
+  p += ptr_size;
+
+  if (aug.starts_with('z')) {
+    u64 len = read_uleb(&p);
+    p += len;
+  }
+
+  std::string_view fde_insns = {(char *)p, (size_t)(end - p)};
+
+  // Run the CFA programs to compute the rows of the CFI table.
+  std::vector<std::pair<u64, CfiRow>> rows;
+  std::vector<CfiRow> stack;
+  CfiRow init;
+  CfiRow cur;
+  u64 loc = 0;
+
+  auto advance = [&](u64 delta) {
+    if (rows.empty() || rows.back().second != cur) {
+      if (!rows.empty() && rows.back().first == loc)
+        rows.back().second = cur;
+      else
+        rows.push_back({loc, cur});
+    }
+    loc += delta * code_align;
+  };
+
+  auto set_offset = [&](u64 reg, i64 offset) {
+    if (reg == fp_reg)
+      cur.fp_offset = offset;
+    else if (reg == ra_reg)
+      cur.ra_offset = offset;
+  };
+
+  auto restore = [&](u64 reg) {
+    if (reg == fp_reg)
+      cur.fp_offset = init.fp_offset;
+    else if (reg == ra_reg)
+      cur.ra_offset = init.ra_offset;
+  };
+
+  auto run = [&](std::string_view insns) -> std::string_view {
+    u8 *p = (u8 *)insns.data();
+    u8 *end = p + insns.size();
+
+    while (p < end) {
+      u8 op = *p++;
+
+      switch (op & 0xc0) {
+      case DW_CFA_advance_loc:
+        advance(op & 0x3f);
+        continue;
+      case DW_CFA_offset:
+        set_offset(op & 0x3f, read_uleb(&p) * data_align);
+        continue;
+      case DW_CFA_restore:
+        restore(op & 0x3f);
+        continue;
+      }
+
+      switch (op) {
+      case DW_CFA_nop:
+        break;
+      case DW_CFA_advance_loc1:
+        advance(*p);
+        p++;
+        break;
+      case DW_CFA_advance_loc2:
+        advance(*(U16<E> *)p);
+        p += 2;
+        break;
+      case DW_CFA_advance_loc4:
+        advance(*(U32<E> *)p);
+        p += 4;
+        break;
+      case DW_CFA_offset_extended: {
+        u64 reg = read_uleb(&p);
+        set_offset(reg, read_uleb(&p) * data_align);
+        break;
+      }
+      case DW_CFA_offset_extended_sf: {
+        u64 reg = read_uleb(&p);
+        set_offset(reg, read_sleb(&p) * data_align);
+        break;
+      }
+      case DW_CFA_restore_extended:
+        restore(read_uleb(&p));
+        break;
+      case DW_CFA_undefined:
+      case DW_CFA_same_value: {
+        u64 reg = read_uleb(&p);
+        if (reg == ra_reg && op == DW_CFA_undefined)
+          return "return address is undefined";
+        if (reg == fp_reg)
+          cur.fp_offset = {};
+        else if (reg == ra_reg)
+          cur.ra_offset = {};
+        break;
+      }
+      case DW_CFA_register: {
+        u64 reg = read_uleb(&p);
+        read_uleb(&p);
+        if (reg == fp_reg || reg == ra_reg)
+          return "FP or RA is saved in a register";
+        break;
+      }
+      case DW_CFA_remember_state:
+        stack.push_back(cur);
+        break;
+      case DW_CFA_restore_state:
+        if (stack.empty())
+          return "unbalanced DW_CFA_restore_state";
+        cur = stack.back();
+        stack.pop_back();
+        break;
+      case DW_CFA_def_cfa:
+        cur.cfa_reg = read_uleb(&p);
+        cur.cfa_offset = read_uleb(&p);
+        break;
+      case DW_CFA_def_cfa_sf:
+        cur.cfa_reg = read_uleb(&p);
+        cur.cfa_offset = read_sleb(&p) * data_align;
+        break;
+      case DW_CFA_def_cfa_register:
+        cur.cfa_reg = read_uleb(&p);
+        break;
+      case DW_CFA_def_cfa_offset:
+        cur.cfa_offset = read_uleb(&p);
+        break;
+      case DW_CFA_def_cfa_offset_sf:
+        cur.cfa_offset = read_sleb(&p) * data_align;
+        break;
+      case DW_CFA_def_cfa_expression:
+        return "CFA is defined by a DWARF expression";
+      case DW_CFA_expression:
+      case DW_CFA_val_expression: {
+        u64 reg = read_uleb(&p);
+        p += read_uleb(&p);
+        if (reg == fp_reg || reg == ra_reg)
+          return "FP or RA is defined by a DWARF expression";
+        break;
+      }
+      case DW_CFA_val_offset:
+      case DW_CFA_val_offset_sf: {
+        u64 reg = read_uleb(&p);
+        read_uleb(&p);
+        if (reg == fp_reg || reg == ra_reg)
+          return "FP or RA is defined by DW_CFA_val_offset";
+        break;
+      }
+      case DW_CFA_GNU_args_size:
+        read_uleb(&p);
+        break;
+      case DW_CFA_AARCH64_negate_ra_state:
+        if (!is_arm64<E>)
+          return "unsupported CFA instruction";
+        cur.ra_mangled = !cur.ra_mangled;
+        break;
+      default:
+        return "unsupported CFA instruction";
+      }
+    }
+    return "";
+  };
+
+  if (std::string_view err = run(cie_insns); !err.empty())
+    return err;
+  init = cur;
+
+  if (std::string_view err = run(fde_insns); !err.empty())
+    return err;
+  advance(0);
+
+  // Instructions past the end of the function don't matter.
+  while (!rows.empty() && rows.back().first >= func_size)
+    rows.pop_back();
+
+  if (rows.empty() || rows[0].first != 0)
+    return "CFA is undefined at function entry";
+  if (rows.size() > UINT16_MAX)
+    return "too many rows";
+
+  // Write an FRE block, which consists of a 5-byte attribute header
+  // followed by FREs. The width of each FRE's start address depends on
+  // the function size.
+  u8 fre_type;
+  i64 addr_size;
+
+  if (func_size <= UINT8_MAX) {
+    fre_type = SFRAME_FRE_TYPE_ADDR1;
+    addr_size = 1;
+  } else if (func_size <= UINT16_MAX) {
+    fre_type = SFRAME_FRE_TYPE_ADDR2;
+    addr_size = 2;
+  } else {
+    fre_type = SFRAME_FRE_TYPE_ADDR4;
+    addr_size = 4;
+  }
+
+  u8 attr[5];
+  *(U16<E> *)attr = rows.size();
+  attr[2] = fre_type | (pauth_key_b << 5);
+  attr[3] = 0;
+  attr[4] = 0;
+  out.append((char *)attr, sizeof(attr));
+
+  for (auto &[addr, row] : rows) {
+    if (row.cfa_reg != sp_reg && row.cfa_reg != fp_reg)
+      return "CFA is not based on SP or FP";
+
+    // On x86-64, RA is always at a fixed offset from CFA, which is
+    // recorded in the SFrame header. On ARM64, RA may stay in the link
+    // register, but if FP is saved, an RA slot must precede it.
+    std::vector<i64> offsets = {row.cfa_offset};
+
+    if constexpr (is_x86_64<E>) {
+      if (row.ra_offset != -8)
+        return "RA is not at CFA-8";
+    } else {
+      if (row.ra_offset || row.fp_offset)
+        offsets.push_back(row.ra_offset.value_or(0));
+    }
+
+    if (row.fp_offset)
+      offsets.push_back(*row.fp_offset);
+
+    i64 max = 0;
+    for (i64 x : offsets)
+      max = std::max(max, x < 0 ? -x - 1 : x);
+
+    i64 size_code = (max <= INT8_MAX) ? 0 : (max <= INT16_MAX) ? 1 : 2;
+    if (max > INT32_MAX)
+      return "offset too large";
+
+    u8 buf[4];
+    *(U32<E> *)buf = addr;
+    out.append((char *)buf + (E::is_le ? 0 : 4 - addr_size), addr_size);
+
+    out += (char)((row.cfa_reg == fp_reg ? SFRAME_BASE_REG_FP : SFRAME_BASE_REG_SP) |
+                  (offsets.size() << 1) | (size_code << 5) |
+                  (row.ra_mangled << 7));
+
+    for (i64 x : offsets) {
+      if (size_code == 0) {
+        out += (char)x;
+      } else if (size_code == 1) {
+        *(I16<E> *)buf = x;
+        out.append((char *)buf, 2);
+      } else {
+        *(I32<E> *)buf = x;
+        out.append((char *)buf, 4);
+      }
+    }
+  }
+
+  num_fres = rows.size();
+  return "";
+}
+
+// Object files written in assembly or taken from third-party archives
+// often have .eh_frame but no .sframe. If --synthesize-sframe is given,
+// we convert their .eh_frame FDEs to SFrame FDEs so that the output
+// .sframe covers those functions too.
+template <typename E>
+void ObjectFile<E>::synthesize_sframe(Context<E> &ctx)
+  requires supports_sframe<E> {
+  if constexpr (is_x86_64<E> || is_arm64<E>) {
+    // Returns a human-readable name of the function an FDE describes.
+    auto describe_fde = [&](const ElfRel<E> &rel, InputSection<E> *isec) {
+      std::stringstream ss;
+      ss << *isec << ": ";
+
+      Symbol<E> &sym = *this->symbols[rel.r_sym];
+      if (sym.esym().st_type != STT_SECTION) {
+        ss << sym;
+        return ss.str();
+      }
+
+      for (i64 i = 1; i < this->elf_syms.size(); i++) {
+        const ElfSym<E> &esym = this->elf_syms[i];
+        if (esym.st_type == STT_FUNC && esym.st_value == rel.r_addend &&
+            get_section(esym) == isec) {
+          ss << *this->symbols[i];
+          return ss.str();
+        }
+      }
+
+      ss << "offset 0x" << std::hex << (u64)rel.r_addend;
+      return ss.str();
+    };
+
+    std::string buf;
+    std::vector<i64> offsets;
+
+    for (FdeRecord<E> &fde : fdes) {
+      const ElfRel<E> &rel = fde.get_rels(*this)[0];
+      InputSection<E> *isec = get_section(this->elf_syms[rel.r_sym]);
+      if (!isec)
+        continue;
+
+      i64 offset = buf.size();
+      i64 num_fres = 0;
+      std::string_view err = eh_frame_to_sframe(*this, fde, buf, num_fres);
+
+      if (!err.empty()) {
+        buf.resize(offset);
+        if (!ctx.arg.print_sframe_failures.empty())
+          sframe_failures.push_back(describe_fde(rel, isec) + ": " +
+                                    std::string(err));
+        continue;
+      }
+
+      std::string_view contents = fde.get_contents(*this);
+      i64 ptr_size = cies[fde.cie_idx].fde_ptr_size;
+      const u8 *range = (u8 *)contents.data() + 8 + ptr_size;
+
+      SFrameFde<E> sfde;
+      sfde.isec = isec;
+      sfde.sym = this->symbols[rel.r_sym];
+      sfde.addend = rel.r_addend;
+      sfde.func_size = (ptr_size == 4) ? *(U32<E> *)range : *(U64<E> *)range;
+      sfde.num_fres = num_fres;
+      sframe_fdes.push_back(sfde);
+      offsets.push_back(offset);
+    }
+
+    if (sframe_fdes.empty())
+      return;
+
+    // Now that the FRE blocks won't move anymore, point FDEs to them.
+    std::string_view fres = save_string(ctx, buf);
+    offsets.push_back(fres.size());
+    for (i64 i = 0; i < sframe_fdes.size(); i++)
+      sframe_fdes[i].fre = fres.substr(offsets[i], offsets[i + 1] - offsets[i]);
+  }
 }
 
 template <typename E>
@@ -956,26 +1366,48 @@ void ObjectFile<E>::sort_relocations(Context<E> &ctx) {
 }
 
 template <typename E>
-void ObjectFile<E>::convert_mergeable_sections(Context<E> &ctx) {
-  // Convert InputSections to MergeableSections
-  for (i64 i = 0; i < this->sections.size(); i++) {
-    InputSection<E> *isec = this->sections[i];
-    if (!isec || isec->sh_size == 0 || isec->relsec_idx != -1)
-      continue;
+static std::unique_ptr<MergeableSection<E>>
+to_mergeable_section(Context<E> &ctx, InputSection<E> *isec) {
+  if (!isec || isec->sh_size == 0 || isec->relsec_idx != -1)
+    return nullptr;
+
+  const ElfShdr<E> &shdr = isec->shdr();
+  if (!(shdr.sh_flags & SHF_MERGE))
+    return nullptr;
+
+  MergedSection<E> *parent =
+    MergedSection<E>::get_instance(ctx, isec->name(), shdr);
+  if (!parent)
+    return nullptr;
+  return std::make_unique<MergeableSection<E>>(ctx, *parent, isec);
+}
 
-    const ElfShdr<E> &shdr = isec->shdr();
-    if (!(shdr.sh_flags & SHF_MERGE))
-      continue;
+// Creates MergeableSections and splits their contents while leaving
+// `sections` intact, as symbol resolution still needs InputSections.
+// This is called while LTO is running. convert_mergeable_sections()
+// will install the results to `sections` later.
+template <typename E>
+void ObjectFile<E>::split_mergeable_sections(Context<E> &ctx) {
+  for (i64 i = 0; i < this->sections.size(); i++) {
+    if (std::unique_ptr<MergeableSection<E>> m =
+        to_mergeable_section(ctx, this->sections[i])) {
+      m->split_contents(ctx);
+      split_sections.emplace_back(i, std::move(m));
+    }
+  }
+}
 
-    MergedSection<E> *parent =
-      MergedSection<E>::get_instance(ctx, isec->name(), shdr);
+template <typename E>
+void ObjectFile<E>::convert_mergeable_sections(Context<E> &ctx) {
+  for (auto &[i, m] : split_sections)
+    this->sections.set_mergeable(i, std::move(m));
+  split_sections.clear();
 
-    if (parent) {
-      std::unique_ptr<MergeableSection<E>> m =
-        std::make_unique<MergeableSection<E>>(ctx, *parent, isec);
+  // Convert InputSections to MergeableSections
+  for (i64 i = 0; i < this->sections.size(); i++)
+    if (std::unique_ptr<MergeableSection<E>> m =
+        to_mergeable_section(ctx, this->sections[i]))
       this->sections.set_mergeable(i, std::move(m));
-    }
-  }
 }
 
 // Usually a section is an atomic unit of inclusion or exclusion.
@@ -1582,10 +2014,17 @@ void SharedFile<E>::parse(Context<E> &ctx) {
     bool has_version = ver != VER_NDX_GLOBAL && ver < version_strings.size() &&
                        !version_strings[ver].empty();
 
-    auto get_versioned_sym = [&] {
-      std::string_view key = save_string(
-        ctx, std::string(name) + "@" + std::string(version_strings[ver]));
-      return get_symbol(ctx, key, name);
+    // As with object files, only record symbol references here and let
+    // gather_symbols() fill in the slots without taking a lock per
+    // symbol. The vectors were reserved above, so the slots don't move.
+    auto add_sym = [&](auto &vec, std::string_view key) {
+      vec.emplace_back();
+      ctx.symbol_map.add(key, vec.back());
+    };
+
+    auto add_versioned_sym = [&](auto &vec) {
+      add_sym(vec, save_string(
+        ctx, std::string(name) + "@" + std::string(version_strings[ver])));
     };
 
     // Symbol resolution involving symbol versioning is tricky because one
@@ -1604,17 +2043,17 @@ void SharedFile<E>::parse(Context<E> &ctx) {
     // visit all symbol references to redirect `foo@VERSION` to `foo`.
     if (!has_version) {
       // Unversioned symbol
-      this->symbols.emplace_back(get_symbol(ctx, name));
-      this->symbols2.push_back(nullptr);
+      add_sym(this->symbols, name);
+      this->symbols2.emplace_back();
     } else if (esyms[i].is_undef() || (vers[i] & VERSYM_HIDDEN)) {
       // Versioned non-default symbol, or undefined reference whose
       // version comes from .gnu.version_r.
-      this->symbols.emplace_back(get_versioned_sym());
-      this->symbols2.push_back(nullptr);
+      add_versioned_sym(this->symbols);
+      this->symbols2.emplace_back();
     } else {
       // Versioned default symbol
-      this->symbols.emplace_back(get_symbol(ctx, name));
-      this->symbols2.push_back(get_versioned_sym());
+      add_sym(this->symbols, name);
+      add_versioned_sym(this->symbols2);
     }
   }
 
@@ -213,6 +213,10 @@ void InputSection<E>::scan_absrel(Context<E> &ctx, Symbol<E> &sym,
 
 template <typename E>
 void InputSection<E>::scan_tlsdesc(Context<E> &ctx, Symbol<E> &sym) {
+  static Counter to_le("tlsdesc_to_le");
+  static Counter to_ie("tlsdesc_to_ie");
+  static Counter norelax("tlsdesc_norelax");
+
   if (ctx.arg.static_ || (ctx.arg.relax && sym.is_tprel_linktime_const(ctx))) {
     // Relax TLSDESC to Local Exec. In this case, we directly materialize
     // a TP-relative offset, so no dynamic relocation is needed.
@@ -221,15 +225,18 @@ void InputSection<E>::scan_tlsdesc(Context<E> &ctx, Symbol<E> &sym) {
     // executables even if -no-relax is given. It is because a
     // statically-linked executable doesn't contain a trampoline
     // function needed for TLSDESC.
+    to_le++;
   } else if (ctx.arg.relax && sym.is_tprel_runtime_const(ctx)) {
     // In this condition, TP-relative offset of a thread-local variable
     // is known at process startup time, so we can relax TLSDESC to the
     // code that reads the TP-relative offset from GOT and add TP to it.
     sym.flags |= NEEDS_GOTTP;
+    to_ie++;
   } else {
     // If no relaxation is doable, we simply create a TLSDESC dynamic
     // relocation.
     sym.flags |= NEEDS_TLSDESC;
+    norelax++;
   }
 }
 
@@ -398,15 +405,73 @@ MergeableSection<E>::MergeableSection(Context<E> &ctx, MergedSection<E> &parent,
   parent.members.push_back(this);
 }
 
-static size_t find_null(std::string_view data, i64 pos, i64 entsize) {
-  if (entsize == 1)
-    return data.find('\0', pos);
+// Returns a bitmask in which the most significant bit of each
+// `entsize`-byte character in the eight bytes at `pos` is set if the
+// character is null. Bytes past the end of `data` are treated as
+// non-null.
+static u64 get_null_mask(std::string_view data, i64 pos, u64 msb) {
+  u64 x;
+  if (pos + 8 <= data.size()) {
+    x = *(ul64 *)(data.data() + pos);
+  } else {
+    u8 buf[8];
+    memset(buf, 0xff, 8);
+    memcpy(buf, data.data() + pos, data.size() - pos);
+    x = *(ul64 *)buf;
+  }
 
-  for (; pos <= data.size() - entsize; pos += entsize)
-    if (data.substr(pos, entsize).find_first_not_of('\0') == data.npos)
-      return pos;
+  // Adding ~msb to the lower bits of a character carries into its most
+  // significant bit unless they are all zero. The addition never
+  // overflows into the next character.
+  return ~(((x & ~msb) + ~msb) | x | ~msb);
+}
 
-  return data.npos;
+// Splits `data` into null-terminated strings and appends their offsets
+// to `offsets`. Returns false if the last string is not terminated.
+static bool split_strings(std::vector<u32> &offsets, std::string_view data,
+                          i64 entsize) {
+  // For byte strings, memchr() is already vectorized by libc.
+  if (entsize == 1) {
+    for (i64 pos = 0; pos < data.size();) {
+      offsets.push_back(pos);
+      size_t end = data.find('\0', pos);
+      if (end == data.npos)
+        return false;
+      pos = end + 1;
+    }
+    return true;
+  }
+
+  // Wide strings are much more expensive to scan one character at a
+  // time, so we look for null characters eight bytes at a time.
+  u64 msb;
+  switch (entsize) {
+  case 2: msb = 0x8000'8000'8000'8000; break;
+  case 4: msb = 0x8000'0000'8000'0000; break;
+  case 8: msb = 0x8000'0000'0000'0000; break;
+  default:
+    for (i64 pos = 0; pos < data.size();) {
+      offsets.push_back(pos);
+      for (;;) {
+        if (pos + entsize > data.size())
+          return false;
+        std::string_view c = data.substr(pos, entsize);
+        pos += entsize;
+        if (c.find_first_not_of('\0') == c.npos)
+          break;
+      }
+    }
+    return true;
+  }
+
+  i64 start = 0;
+  for (i64 pos = 0; pos < data.size(); pos += 8) {
+    for (u64 mask = get_null_mask(data, pos, msb); mask; mask &= mask - 1) {
+      offsets.push_back(start);
+      start = pos + ((std::countr_zero(mask) / 8) & ~(entsize - 1)) + entsize;
+    }
+  }
+  return start == data.size();
 }
 
 // Mergeable sections (sections with SHF_MERGE bit) typically contain
@@ -428,6 +493,10 @@ static size_t find_null(std::string_view data, i64 pos, i64 entsize) {
 // We do not support mergeable sections that have relocations.
 template <typename E>
 void MergeableSection<E>::split_contents(Context<E> &ctx) {
+  // This section may have been split while LTO was running.
+  if (!frag_offsets.empty())
+    return;
+
   std::string_view data = input_section->get_contents();
   if (data.size() > UINT32_MAX)
     Fatal(ctx) << *input_section << ": mergeable section too large";
@@ -436,13 +505,8 @@ void MergeableSection<E>::split_contents(Context<E> &ctx) {
 
   // Split sections
   if (parent.shdr.sh_flags & SHF_STRINGS) {
-    for (i64 pos = 0; pos < data.size();) {
-      frag_offsets.push_back(pos);
-      size_t end = find_null(data, pos, entsize);
-      if (end == data.npos)
-        Fatal(ctx) << *input_section << ": string is not null terminated";
-      pos = end + entsize;
-    }
+    if (!split_strings(frag_offsets, data, entsize))
+      Fatal(ctx) << *input_section << ": string is not null terminated";
   } else {
     if (data.size() % entsize)
       Fatal(ctx) << *input_section
@@ -598,6 +598,544 @@ create_plugin_input_file(Context<E> &ctx, MappedFile *mf) {
   return file;
 }
 
+// LLVM bitcode files contain a precomputed symbol table called irsymtab
+// so that a linker doesn't have to load a module to know its symbols.
+// We read it directly instead of calling claim_file_hook(), which is
+// slow and has to be serialized. Such files are claimed later in
+// run_lto_plugin().
+//
+// The bitstream container format is described at
+// https://llvm.org/docs/BitCodeFormat.html, and the irsymtab layout is
+// defined in llvm/Object/IRSymtab.h.
+namespace {
+class BitReader {
+public:
+  BitReader(std::string_view buf) : buf(buf) {}
+
+  u64 read(i64 nbits) {
+    if (nbits > 64 || buf.size() * 8 < pos + nbits) {
+      error = true;
+      return 0;
+    }
+
+    u64 val = 0;
+    for (i64 i = 0; i < nbits; i++, pos++)
+      val |= (u64)((buf[pos / 8] >> (pos % 8)) & 1) << i;
+    return val;
+  }
+
+  u64 read_vbr(i64 nbits) {
+    if (nbits < 2) {
+      error = true;
+      return 0;
+    }
+
+    u64 val = 0;
+    for (i64 shift = 0; shift < 64 && !error; shift += nbits - 1) {
+      u64 x = read(nbits);
+      val |= (x & ((1LL << (nbits - 1)) - 1)) << shift;
+      if (!(x >> (nbits - 1)))
+        return val;
+    }
+    error = true;
+    return 0;
+  }
+
+  void align() {
+    pos = align_to(pos, 32);
+  }
+
+  std::string_view buf;
+  i64 pos = 0;
+  bool error = false;
+};
+
+struct IrSymtab {
+  std::string_view producer;
+  std::vector<PluginSymbol> syms;
+};
+}
+
+// Reads a SYMTAB_BLOCK or a STRTAB_BLOCK and returns the blob of the
+// first record with code 1 (SYMTAB_BLOB or STRTAB_BLOB).
+static std::optional<std::string_view>
+read_blob_block(BitReader &r, i64 width) {
+  enum { LITERAL, FIXED, VBR, ARRAY, CHAR6, BLOB };
+
+  struct AbbrevOp {
+    u64 kind = LITERAL;
+    u64 value = 0;
+  };
+
+  std::vector<std::vector<AbbrevOp>> abbrevs;
+  std::optional<std::string_view> blob;
+
+  auto read_scalar = [&](AbbrevOp &op) -> u64 {
+    switch (op.kind) {
+    case LITERAL:
+      return op.value;
+    case FIXED:
+      return r.read(op.value);
+    case VBR:
+      return r.read_vbr(op.value);
+    case CHAR6:
+      return r.read(6);
+    }
+    r.error = true;
+    return 0;
+  };
+
+  while (!r.error) {
+    u64 id = r.read(width);
+
+    // END_BLOCK
+    if (id == 0) {
+      r.align();
+      return blob;
+    }
+
+    // DEFINE_ABBREV
+    if (id == 2) {
+      u64 num_ops = r.read_vbr(5);
+      if (num_ops == 0 || num_ops > 64)
+        return {};
+
+      std::vector<AbbrevOp> &ops = abbrevs.emplace_back(num_ops);
+      for (AbbrevOp &op : ops) {
+        if (r.read(1)) {
+          op.value = r.read_vbr(8);
+        } else {
+          op.kind = r.read(3);
+          if (op.kind == FIXED || op.kind == VBR)
+            op.value = r.read_vbr(5);
+        }
+      }
+      continue;
+    }
+
+    // Sub-blocks and unabbreviated records are not expected here.
+    if (id < 4 || abbrevs.size() <= id - 4)
+      return {};
+
+    std::vector<AbbrevOp> &ops = abbrevs[id - 4];
+    std::optional<u64> code;
+    std::string_view data;
+
+    for (i64 i = 0; i < ops.size() && !r.error; i++) {
+      if (ops[i].kind == ARRAY) {
+        if (++i == ops.size())
+          return {};
+        u64 len = r.read_vbr(6);
+        for (u64 j = 0; j < len && !r.error; j++)
+          read_scalar(ops[i]);
+      } else if (ops[i].kind == BLOB) {
+        u64 len = r.read_vbr(6);
+        r.align();
+        if (r.buf.size() < r.pos / 8 + len)
+          return {};
+        data = r.buf.substr(r.pos / 8, len);
+        r.pos += len * 8;
+        r.align();
+      } else {
+        u64 val = read_scalar(ops[i]);
+        if (!code)
+          code = val;
+      }
+    }
+
+    if (code == 1 && !blob)
+      blob = data;
+  }
+  return {};
+}
+
+// Returns the same symbols as LLVMgold's claim_file_hook() would return
+// for a given file. Returns nullopt if we can't handle the file, in
+// which case the caller falls back to the plugin.
+template <typename E>
+static std::optional<IrSymtab>
+read_llvm_symtab(Context<E> &ctx, std::string_view data) {
+  // Skip a bitcode wrapper header if exists
+  if (data.size() >= 20 && *(ul32 *)data.data() == 0x0b17c0de) {
+    u64 offset = *(ul32 *)(data.data() + 8);
+    u64 size = *(ul32 *)(data.data() + 12);
+    if (data.size() < offset + size)
+      return {};
+    data = data.substr(offset, size);
+  }
+
+  if (!data.starts_with("BC\xc0\xde"))
+    return {};
+
+  // Read top-level blocks. At the top level, the abbreviation ID width
+  // is 2, and only ENTER_SUBBLOCK (1) may appear.
+  BitReader r(data);
+  r.pos = 32;
+
+  std::string_view symtab;
+  std::string_view strtab;
+  i64 num_modules = 0;
+
+  while (r.pos / 8 + 8 < data.size()) {
+    if (r.read(2) != 1)
+      return {};
+
+    u64 block_id = r.read_vbr(8);
+    u64 width = r.read_vbr(4);
+    r.align();
+    u64 num_words = r.read(32);
+    i64 end = r.pos + num_words * 32;
+
+    if (r.error || width == 0 || width > 32 || data.size() * 8 < end)
+      return {};
+
+    if (block_id == 8) {
+      // MODULE_BLOCK
+      num_modules++;
+    } else if (block_id == 25 && symtab.empty()) {
+      // SYMTAB_BLOCK
+      std::optional<std::string_view> blob = read_blob_block(r, width);
+      if (!blob)
+        return {};
+      symtab = *blob;
+    } else if (block_id == 23 && !symtab.empty() && strtab.empty()) {
+      // STRTAB_BLOCK
+      std::optional<std::string_view> blob = read_blob_block(r, width);
+      if (!blob)
+        return {};
+      strtab = *blob;
+    }
+    r.pos = end;
+  }
+
+  // Parse the irsymtab. LLVM rebuilds it from IR if it was created by an
+  // unknown version or doesn't cover all modules in the file, so we give
+  // up in that case.
+  if (symtab.size() < 76 || strtab.empty())
+    return {};
+
+  auto word = [&](i64 offset) -> u32 {
+    return *(ul32 *)(symtab.data() + offset);
+  };
+
+  auto str = [&](i64 offset) -> std::optional<std::string_view> {
+    u64 begin = word(offset);
+    u64 size = word(offset + 4);
+    if (strtab.size() < begin + size)
+      return {};
+    return strtab.substr(begin, size);
+  };
+
+  auto range = [&](i64 offset, i64 entsize) -> std::pair<i64, i64> {
+    i64 begin = word(offset);
+    i64 size = word(offset + 4);
+    if (symtab.size() < begin + size * entsize)
+      return {0, 0};
+    return {begin, size};
+  };
+
+  if (word(0) != 3 || word(16) != num_modules)
+    return {};
+
+  IrSymtab ret;
+  if (std::optional<std::string_view> producer = str(4))
+    ret.producer = save_string(ctx, std::string(*producer));
+  else
+    return {};
+
+  // LLVMgold doesn't report a comdat key if the comdat's SelectionKind
+  // is NoDeduplicate (3).
+  auto [comdat_begin, num_comdats] = range(20, 12);
+  std::vector<std::string_view> comdats(num_comdats);
+
+  for (i64 i = 0; i < num_comdats; i++) {
+    std::optional<std::string_view> name = str(comdat_begin + i * 12);
+    if (!name)
+      return {};
+    if (word(comdat_begin + i * 12 + 8) != 3)
+      comdats[i] = *name;
+  }
+
+  // Read symbols. Symbol flags are defined in storage::Symbol::FlagBits.
+  enum {
+    FB_undefined = 3,
+    FB_weak = 4,
+    FB_common = 5,
+    FB_global = 10,
+    FB_format_specific = 11,
+  };
+
+  auto [sym_begin, num_syms] = range(28, 24);
+  std::vector<std::string_view> names;
+  std::vector<std::string_view> keys;
+
+  for (i64 i = 0; i < num_syms; i++) {
+    i64 offset = sym_begin + i * 24;
+    i32 comdat_idx = word(offset + 16);
+    u32 flags = word(offset + 20);
+
+    // LLVM ignores symbols that are irrelevant to LTO
+    if (!(flags & (1 << FB_global)) || (flags & (1 << FB_format_specific)))
+      continue;
+
+    std::optional<std::string_view> name = str(offset);
+    if (!name || num_comdats <= comdat_idx)
+      return {};
+
+    PluginSymbol psym = {};
+
+    if (flags & (1 << FB_undefined))
+      psym.def = (flags & (1 << FB_weak)) ? LDPK_WEAKUNDEF : LDPK_UNDEF;
+    else if (flags & (1 << FB_common))
+      psym.def = LDPK_COMMON;
+    else if (flags & (1 << FB_weak))
+      psym.def = LDPK_WEAKDEF;
+    else
+      psym.def = LDPK_DEF;
+
+    // The lowest two bits are GlobalValue::VisibilityTypes
+    if ((flags & 3) == 1)
+      psym.visibility = LDPV_HIDDEN;
+    else if ((flags & 3) == 2)
+      psym.visibility = LDPV_PROTECTED;
+
+    ret.syms.push_back(psym);
+    names.push_back(*name);
+    keys.push_back(comdat_idx < 0 ? "" : comdats[comdat_idx]);
+  }
+
+  // Symbol names and comdat keys have to be NUL-terminated, so we copy
+  // them to a single buffer.
+  std::string buf;
+  std::vector<i64> offsets;
+
+  for (i64 i = 0; i < ret.syms.size(); i++) {
+    offsets.push_back(buf.size());
+    buf += names[i];
+    buf += '\0';
+    offsets.push_back(buf.size());
+    buf += keys[i];
+    buf += '\0';
+  }
+
+  char *p = (char *)save_string(ctx, buf).data();
+
+  for (i64 i = 0; i < ret.syms.size(); i++) {
+    ret.syms[i].name = p + offsets[i * 2];
+    if (!keys[i].empty())
+      ret.syms[i].comdat_key = p + offsets[i * 2 + 1];
+  }
+  return ret;
+}
+
+// GCC IR object files are ELF files. Symbols for the linker plugin are
+// stored in a .gnu.lto_.symtab.<id> section as a sequence of entries in
+// the following format:
+//
+//   name, comdat key: NUL-terminated strings
+//   kind (LDPK_*), visibility (LDPV_*): u8
+//   size: u64
+//   slot: u32
+//
+// GCC 12 or later also emits .gnu.lto_.ext_symtab.<id>, which consists
+// of a version byte (1) followed by a pair of a symbol type (LDST_*) and
+// a section kind for each symbol.
+//
+// Returns the same symbols as GCC's liblto_plugin would return, or
+// nullopt if we can't handle the file.
+template <typename E>
+static std::optional<IrSymtab>
+read_gcc_symtab(Context<E> &ctx, std::string_view data) {
+  if (data.size() < sizeof(ElfEhdr<E>) || !data.starts_with("\177ELF"))
+    return {};
+
+  ElfEhdr<E> &ehdr = *(ElfEhdr<E> *)data.data();
+  if (data.size() < ehdr.e_shoff + ehdr.e_shnum * sizeof(ElfShdr<E>))
+    return {};
+
+  std::span<ElfShdr<E>> shdrs{(ElfShdr<E> *)(data.data() + ehdr.e_shoff),
+                              (size_t)ehdr.e_shnum};
+  if (shdrs.empty())
+    return {};
+
+  i64 shstrtab_idx = (ehdr.e_shstrndx == SHN_XINDEX)
+    ? shdrs[0].sh_link : ehdr.e_shstrndx;
+  if (shdrs.size() <= shstrtab_idx)
+    return {};
+
+  auto get_contents = [&](ElfShdr<E> &shdr) -> std::string_view {
+    if (data.size() < shdr.sh_offset + shdr.sh_size)
+      return {};
+    return data.substr(shdr.sh_offset, shdr.sh_size);
+  };
+
+  std::string_view shstrtab = get_contents(shdrs[shstrtab_idx]);
+  std::string_view symtab;
+  std::string_view ext;
+  std::string_view header;
+  i64 num_symtabs = 0;
+
+  for (ElfShdr<E> &shdr : shdrs) {
+    if (shstrtab.size() <= shdr.sh_name)
+      return {};
+
+    std::string_view name = shstrtab.data() + shdr.sh_name;
+    if (name.starts_with(".gnu.lto_.symtab")) {
+      symtab = get_contents(shdr);
+      num_symtabs++;
+    } else if (name.starts_with(".gnu.lto_.ext_symtab")) {
+      ext = get_contents(shdr);
+    } else if (name.starts_with(".gnu.lto_.lto.")) {
+      header = get_contents(shdr);
+    }
+  }
+
+  // If an object file was created by `ld -r`, it may contain multiple
+  // symbol tables. The plugin merges them in a complicated way.
+  if (num_symtabs != 1 || symtab.empty() || header.size() < 4)
+    return {};
+
+  // The LTO bytecode version
+  IrSymtab ret;
+  ret.producer = save_string(ctx, "gcc-lto-" +
+                             std::to_string(*(U16<E> *)header.data()) + "." +
+                             std::to_string(*(U16<E> *)(header.data() + 2)));
+
+  while (!symtab.empty()) {
+    PluginSymbol psym = {};
+
+    // Read a name and a comdat key
+    size_t pos = symtab.find('\0');
+    if (pos == symtab.npos)
+      return {};
+    psym.name = (char *)symtab.data();
+    symtab = symtab.substr(pos + 1);
+
+    pos = symtab.find('\0');
+    if (pos == symtab.npos)
+      return {};
+    if (pos > 0)
+      psym.comdat_key = (char *)symtab.data();
+    symtab = symtab.substr(pos + 1);
+
+    // Read the rest
+    if (symtab.size() < 14 || (u8)symtab[0] > LDPK_COMMON ||
+        (u8)symtab[1] > LDPV_HIDDEN)
+      return {};
+
+    psym.def = symtab[0];
+    psym.visibility = symtab[1];
+    memcpy(&psym.size, symtab.data() + 2, 8);
+    symtab = symtab.substr(14);
+    ret.syms.push_back(psym);
+  }
+
+  // The plugin reads the extension table only if the linker supports
+  // LDPT_ADD_SYMBOLS_V2, which we do.
+  if (!ext.empty()) {
+    if (ext[0] != 1 || ext.size() != ret.syms.size() * 2 + 1)
+      return {};
+
+    for (i64 i = 0; i < ret.syms.size(); i++) {
+      if ((u8)ext[i * 2 + 1] > LDST_VARIABLE)
+        return {};
+      ret.syms[i].symbol_type = ext[i * 2 + 1];
+      ret.syms[i].section_kind = ext[i * 2 + 2];
+    }
+  }
+  return ret;
+}
+
+template <typename E>
+static std::optional<IrSymtab> read_symtab(Context<E> &ctx, MappedFile *mf) {
+  if (is_llvm(ctx))
+    return read_llvm_symtab(ctx, mf->get_contents());
+  return read_gcc_symtab(ctx, mf->get_contents());
+}
+
+static bool is_same_symbols(std::span<PluginSymbol> a,
+                            std::span<PluginSymbol> b) {
+  auto eq = [](const char *x, const char *y) {
+    return (!x && !y) || (x && y && !strcmp(x, y));
+  };
+
+  if (a.size() != b.size())
+    return false;
+
+  for (i64 i = 0; i < a.size(); i++)
+    if (!eq(a[i].name, b[i].name) || a[i].def != b[i].def ||
+        a[i].symbol_type != b[i].symbol_type ||
+        a[i].visibility != b[i].visibility || a[i].size != b[i].size ||
+        !eq(a[i].comdat_key, b[i].comdat_key))
+      return false;
+  return true;
+}
+
+// A plugin may interpret a symbol table differently depending on its
+// producer. For example, LLVMgold rebuilds the symbol table of a file
+// from IR if the file was created by a different version of LLVM than
+// the plugin's. So we use symbol tables only if their producer is the
+// same as the one of a file for which we have verified that the plugin
+// returns the same symbols as ours.
+static std::atomic_bool has_trusted_producer;
+static std::string trusted_producer;
+
+template <typename E>
+static ObjectFile<E> *new_lto_object(Context<E> &ctx, MappedFile *mf) {
+  ObjectFile<E> *obj = ctx.arena.template make<ObjectFile<E>>(ctx);
+  ctx.obj_pool.emplace_back(obj);
+
+  obj->filename = mf->name;
+  Symbol<E> *dummy = ctx.arena.template make<Symbol<E>>();
+  obj->symbols.emplace_back(dummy);
+  obj->first_global = 1;
+  obj->is_lto_input = true;
+  obj->mf = mf;
+  obj->archive_name = mf->parent ? mf->parent->name : "";
+  return obj;
+}
+
+template <typename E>
+static void
+set_lto_symbols(Context<E> &ctx, ObjectFile<E> *obj,
+                std::span<PluginSymbol> syms) {
+  // Create a symbol strtab
+  i64 strtab_size = 1;
+  for (PluginSymbol &psym : syms)
+    strtab_size += strlen(psym.name) + 1;
+  std::string strtab(strtab_size, '\0');
+
+  // Initialize esyms
+  obj->lto_elf_syms.resize(syms.size() + 1);
+  obj->lto_comdat_signatures.resize(syms.size() + 1);
+  obj->lto_comdat_discarded.resize(syms.size() + 1);
+  i64 strtab_offset = 1;
+
+  for (i64 i = 0; i < syms.size(); i++) {
+    PluginSymbol &psym = syms[i];
+    obj->lto_elf_syms[i + 1] = to_elf_sym<E>(psym);
+    obj->lto_elf_syms[i + 1].st_name = strtab_offset;
+
+    i64 len = strlen(psym.name);
+    memcpy(strtab.data() + strtab_offset, psym.name, len);
+    strtab_offset += len + 1;
+
+    // comdat_key is non-null if the symbol is defined in a comdat member
+    // section. We handle such symbols differently than comdat symbols in
+    // a regular file because, unlike regular object files, IR files don't
+    // have input sections.
+    if (psym.comdat_key) {
+      std::string_view key = save_string(ctx, psym.comdat_key);
+      obj->lto_comdat_signatures[i + 1] = get_symbol(ctx, key);
+    }
+  }
+
+  obj->symbol_strtab = save_string(ctx, strtab);
+  obj->elf_syms = obj->lto_elf_syms;
+  obj->populate_symbol_name_lengths();
+  obj->register_global_symbols(ctx);
+}
+
 template <typename E>
 ObjectFile<E> *read_lto_object(Context<E> &ctx, MappedFile *mf) {
   if (ctx.arg.plugin.empty())
@@ -608,6 +1146,21 @@ ObjectFile<E> *read_lto_object(Context<E> &ctx, MappedFile *mf) {
 
   load_lto_plugin(ctx);
 
+  // For --stats. They tell which of the two paths below read the symbols.
+  static Counter native_symtabs("lto_native_symtabs");
+  static Counter plugin_symtabs("lto_plugin_symtabs");
+
+  if (has_trusted_producer.load(std::memory_order_acquire)) {
+    std::optional<IrSymtab> symtab = read_symtab(ctx, mf);
+    if (symtab && symtab->producer == trusted_producer) {
+      ObjectFile<E> *obj = new_lto_object(ctx, mf);
+      obj->is_lto_claim_deferred = true;
+      set_lto_symbols(ctx, obj, symtab->syms);
+      native_symtabs++;
+      return obj;
+    }
+  }
+
   // We read input files in parallel, but the plugin interface is not
   // ready for concurrent claims: claim_file_hook() returns a file's
   // symbol table through the add_symbols() callback into a global
@@ -618,17 +1171,7 @@ ObjectFile<E> *read_lto_object(Context<E> &ctx, MappedFile *mf) {
   std::scoped_lock lock(mu);
 
   // Create mold's object instance
-  ObjectFile<E> *obj =
-    ctx.arena.template make<ObjectFile<E>>(ctx);
-  ctx.obj_pool.emplace_back(obj);
-
-  obj->filename = mf->name;
-  Symbol<E> *dummy = ctx.arena.template make<Symbol<E>>();
-  obj->symbols.emplace_back(dummy);
-  obj->first_global = 1;
-  obj->is_lto_input = true;
-  obj->mf = mf;
-  obj->archive_name = mf->parent ? mf->parent->name : "";
+  ObjectFile<E> *obj = new_lto_object(ctx, mf);
 
   // Create plugin's object instance
   PluginInputFile file = create_plugin_input_file(ctx, mf);
@@ -653,43 +1196,59 @@ ObjectFile<E> *read_lto_object(Context<E> &ctx, MappedFile *mf) {
     return nullptr;
   }
 
-  // Create a symbol strtab
-  i64 strtab_size = 1;
-  for (PluginSymbol &psym : plugin_symbols)
-    strtab_size += strlen(psym.name) + 1;
-  std::string strtab(strtab_size, '\0');
+  if (!has_trusted_producer) {
+    std::optional<IrSymtab> symtab = read_symtab(ctx, mf);
+    if (symtab && is_same_symbols(symtab->syms, plugin_symbols)) {
+      trusted_producer = symtab->producer;
+      has_trusted_producer.store(true, std::memory_order_release);
+    }
+  }
 
-  // Initialize esyms
-  obj->lto_elf_syms.resize(plugin_symbols.size() + 1);
-  obj->lto_comdat_signatures.resize(plugin_symbols.size() + 1);
-  obj->lto_comdat_discarded.resize(plugin_symbols.size() + 1);
-  i64 strtab_offset = 1;
+  set_lto_symbols(ctx, obj, plugin_symbols);
+  plugin_symbols.clear();
+  plugin_symtabs++;
+  return obj;
+}
 
-  for (i64 i = 0; i < plugin_symbols.size(); i++) {
-    PluginSymbol &psym = plugin_symbols[i];
-    obj->lto_elf_syms[i + 1] = to_elf_sym<E>(psym);
-    obj->lto_elf_syms[i + 1].st_name = strtab_offset;
+// Passes a file whose symbols were read by read_symtab() to the plugin.
+template <typename E>
+static void claim_deferred_file(Context<E> &ctx, ObjectFile<E> *obj) {
+  PluginInputFile file = create_plugin_input_file(ctx, obj->mf);
+  file.handle = (void *)obj;
 
-    i64 len = strlen(psym.name);
-    memcpy(strtab.data() + strtab_offset, psym.name, len);
-    strtab_offset += len + 1;
+  LOG << "claim_deferred_file: " << obj->mf->name << "\n";
 
-    // comdat_key is non-null if the symbol is defined in a comdat member
-    // section. We handle such symbols differently than comdat symbols in
-    // a regular file because, unlike regular object files, IR files don't
-    // have input sections.
-    if (psym.comdat_key) {
-      std::string_view key = save_string(ctx, psym.comdat_key);
-      obj->lto_comdat_signatures[i + 1] = get_symbol(ctx, key);
-    }
-  }
+  int claimed = false;
+  claim_file_hook(&file, &claimed);
 
-  obj->symbol_strtab = save_string(ctx, strtab);
-  obj->elf_syms = obj->lto_elf_syms;
-  obj->populate_symbol_name_lengths();
-  obj->register_global_symbols(ctx);
+  if (obj->mf->parent)
+    obj->mf->parent->close_fd();
+  else
+    obj->mf->close_fd();
+
+  if (!claimed)
+    Fatal(ctx) << *obj << ": not claimed by the LTO plugin";
+
+  // Make sure that the plugin agrees with us as to the symbol list.
+  auto is_same = [&](i64 i) {
+    ElfSym<E> &esym = obj->lto_elf_syms[i + 1];
+    ElfSym<E> esym2 = to_elf_sym<E>(plugin_symbols[i]);
+    std::string_view name = obj->symbol_strtab.data() + esym.st_name;
+    return name == plugin_symbols[i].name && esym.st_shndx == esym2.st_shndx &&
+           esym.st_type == esym2.st_type && esym.st_bind == esym2.st_bind &&
+           esym.st_visibility == esym2.st_visibility &&
+           esym.st_size == esym2.st_size;
+  };
+
+  if (plugin_symbols.size() != obj->lto_elf_syms.size() - 1)
+    Fatal(ctx) << *obj << ": the LTO plugin returned an unexpected number"
+               << " of symbols";
+
+  for (i64 i = 0; i < plugin_symbols.size(); i++)
+    if (!is_same(i))
+      Fatal(ctx) << *obj << ": the LTO plugin returned an unexpected"
+                 << " symbol: " << plugin_symbols[i].name;
   plugin_symbols.clear();
-  return obj;
 }
 
 // Entry point
@@ -698,7 +1257,13 @@ std::vector<ObjectFile<E> *> run_lto_plugin(Context<E> &ctx) {
   Timer t(ctx, "run_lto_plugin");
   load_lto_plugin(ctx);
 
-  if (!ctx.arg.lto_pass2 && !supports_v3_api(ctx))
+  // Files whose symbols we read without the plugin are claimed only if
+  // they are reachable, so only plugin-read files need the workaround.
+  if (!ctx.arg.lto_pass2 && !supports_v3_api(ctx) &&
+      ranges::any_of(ctx.objs, [](ObjectFile<E> *file) {
+        return file->is_lto_input && !file->is_reachable &&
+               !file->is_lto_claim_deferred;
+      }))
     restart_process(ctx);
 
   assert(phase == 1);
@@ -733,6 +1298,23 @@ std::vector<ObjectFile<E> *> run_lto_plugin(Context<E> &ctx) {
   for (Symbol<E> *sym : ctx.arg.undefined)
     sym->referenced_by_regular_obj = true;
 
+  // Claim IR files whose symbols we read without the plugin. We do this
+  // in the command line order, so the LTO result is deterministic.
+  for (ObjectFile<E> *file : ctx.objs)
+    if (file->is_reachable && file->is_lto_claim_deferred)
+      claim_deferred_file(ctx, file);
+
+  // Make sure that IR files we didn't claim don't keep their file
+  // descriptors open. Claimed ones have been closed above.
+  for (ObjectFile<E> *file : ctx.objs) {
+    if (file->is_lto_claim_deferred && !file->is_reachable) {
+      if (file->mf->parent)
+        file->mf->parent->close_fd();
+      else
+        file->mf->close_fd();
+    }
+  }
+
   // Object files containing .gnu.offload_lto_.* sections need to be
   // given to the LTO backend. Such sections contains code and data for
   // peripherails (typically GPUs).
@@ -23,8 +23,8 @@ check_file_compatibility(Context<E> &ctx, ReaderContext &rctx, MappedFile *mf) {
 }
 
 template <typename E>
-static void new_object_file(Context<E> &ctx, ReaderContext &rctx,
-                            MappedFile *mf, std::string archive_name) {
+static ObjectFile<E> *new_object_file(Context<E> &ctx, ReaderContext &rctx,
+                                      MappedFile *mf, std::string archive_name) {
   static Counter count("parsed_objs");
   count++;
 
@@ -38,26 +38,28 @@ static void new_object_file(Context<E> &ctx, ReaderContext &rctx,
 
   file->parse_symbols(ctx);
   ctx.unsorted_input_files.push_back({rctx.pos, file});
+  return file;
 }
 
 template <typename E>
-static void new_lto_obj(Context<E> &ctx, ReaderContext &rctx,
-                        MappedFile *mf, std::string archive_name) {
+static ObjectFile<E> *new_lto_obj(Context<E> &ctx, ReaderContext &rctx,
+                                  MappedFile *mf, std::string archive_name) {
   static Counter count("parsed_lto_objs");
   count++;
 
   if (ctx.arg.ignore_ir_file.count(mf->get_identifier()))
-    return;
+    return nullptr;
 
   ObjectFile<E> *file = read_lto_object(ctx, mf);
   if (!file)
-    return;
+    return nullptr;
 
   file->archive_name = archive_name;
   file->as_needed =
     rctx.in_lib || (!archive_name.empty() && !rctx.whole_archive);
 
   ctx.unsorted_input_files.push_back({rctx.pos, file});
+  return file;
 }
 
 template <typename E>
@@ -78,22 +80,21 @@ static void new_shared_file(Context<E> &ctx, ReaderContext &rctx,
 
 // Reads a file inside an archive.
 template <typename E>
-static void read_archive_member(Context<E> &ctx, ReaderContext &rctx,
-                                MappedFile *mf, std::string archive_name) {
+static ObjectFile<E> *
+read_archive_member(Context<E> &ctx, ReaderContext &rctx, MappedFile *mf,
+                    std::string archive_name) {
   switch (get_file_type(ctx, mf)) {
   case FileType::ELF_OBJ:
-    new_object_file(ctx, rctx, mf, archive_name);
-    break;
+    return new_object_file(ctx, rctx, mf, archive_name);
   case FileType::GCC_LTO_OBJ:
   case FileType::LLVM_BITCODE:
-    new_lto_obj(ctx, rctx, mf, archive_name);
-    break;
+    return new_lto_obj(ctx, rctx, mf, archive_name);
   case FileType::ELF_DSO:
     Warn(ctx) << archive_name << "(" << mf->name
               << "): shared object file in an archive is ignored";
-    break;
+    return nullptr;
   default:
-    break;
+    return nullptr;
   }
 }
 
@@ -169,28 +170,279 @@ MappedFile *open_library(Context<E> &ctx, ReaderContext &rctx, std::string path)
   return mf;
 }
 
+// find_library() looks for a library in each library search directory
+// in turn. With hundreds of -L and -l options, most attempts to open a
+// file would fail, which is slow on network file systems. Instead, we
+// list the directories once in parallel and look up the listings.
 template <typename E>
-MappedFile *find_library(Context<E> &ctx, ReaderContext &rctx, std::string name) {
-  if (name.starts_with(':')) {
-    for (std::string_view dir : ctx.arg.library_paths) {
-      std::string path = std::string(dir) + "/" + name.substr(1);
-      if (MappedFile *mf = open_library(ctx, rctx, path))
-        return mf;
+static void index_library_paths(Context<E> &ctx) {
+  Timer t(ctx, "index_library_paths");
+
+  std::vector<std::string> &dirs = ctx.arg.library_paths;
+  ctx.library_path_files.resize(dirs.size());
+
+  tbb::parallel_for((i64)0, (i64)dirs.size(), [&](i64 i) {
+    std::optional<std::unordered_set<std::string>> &files =
+      ctx.library_path_files[i];
+
+    std::error_code ec;
+    std::filesystem::directory_iterator it(get_host_path(ctx, dirs[i]), ec);
+
+    // A nonexistent directory contains no files. If we failed to list a
+    // directory for any other reason, we try to open files in it as usual.
+    if (ec) {
+      if (ec == std::errc::no_such_file_or_directory)
+        files.emplace();
+      return;
+    }
+
+    files.emplace();
+    for (; it != std::filesystem::end(it); it.increment(ec)) {
+      if (ec) {
+        files.reset();
+        return;
+      }
+      files->insert(it->path().filename().string());
+    }
+  });
+}
+
+// Returns paths at which `-l<name>` may be found, in the order of
+// precedence.
+template <typename E>
+static std::vector<std::string>
+get_library_candidates(Context<E> &ctx, std::string_view name, bool is_static) {
+  std::vector<std::string> vec;
+
+  auto add = [&](i64 i, std::string filename) {
+    if (i < ctx.library_path_files.size() && filename.find('/') == filename.npos)
+      if (std::optional<std::unordered_set<std::string>> &files =
+          ctx.library_path_files[i])
+        if (!files->contains(filename))
+          return;
+    vec.push_back(ctx.arg.library_paths[i] + "/" + filename);
+  };
+
+  for (i64 i = 0; i < ctx.arg.library_paths.size(); i++) {
+    if (name.starts_with(':')) {
+      add(i, std::string(name.substr(1)));
+    } else {
+      if (!is_static)
+        add(i, "lib" + std::string(name) + ".so");
+      add(i, "lib" + std::string(name) + ".a");
     }
-    Fatal(ctx) << "library not found: " << name;
   }
+  return vec;
+}
 
-  for (std::string_view dir : ctx.arg.library_paths) {
-    std::string stem = std::string(dir) + "/lib" + name;
-    if (!rctx.static_)
-      if (MappedFile *mf = open_library(ctx, rctx, stem + ".so"))
-        return mf;
-    if (MappedFile *mf = open_library(ctx, rctx, stem + ".a"))
+template <typename E>
+MappedFile *find_library(Context<E> &ctx, ReaderContext &rctx, std::string name) {
+  for (std::string &path : get_library_candidates(ctx, name, rctx.static_))
+    if (MappedFile *mf = open_library(ctx, rctx, path))
       return mf;
-  }
   Fatal(ctx) << "library not found: " << name;
 }
 
+// Input files are often on a cold disk or a network file system. Since
+// read_input_files() reads files via mmap(), its worker threads would
+// then stall on page faults one page at a time. To avoid that, we ask
+// the kernel to read input files in the background as soon as we know
+// their names. We first request the first page of every file, which
+// contains the ELF header, and then their section header tables and
+// symbol tables, which the reader touches next.
+template <typename E>
+static void prefetch_input_files(Context<E> &ctx,
+                                 std::span<const ReaderJob> jobs,
+                                 std::atomic_bool &stop) {
+  Timer t(ctx, "prefetch_input_files");
+
+  // Libraries are searched for in the same way as find_library() does,
+  // except that we don't check if a file is compatible.
+  auto find_library_path = [&](const ReaderJob &job) -> std::string {
+    for (std::string &path :
+         get_library_candidates(ctx, job.name, job.rctx.static_)) {
+      std::error_code ec;
+      if (std::filesystem::exists(get_host_path(ctx, path), ec))
+        return path;
+    }
+    return "";
+  };
+
+  std::vector<std::string> paths(jobs.size());
+
+  tbb::parallel_for((i64)0, (i64)jobs.size(), [&](i64 i) {
+    if (stop)
+      return;
+
+    const ReaderJob &job = jobs[i];
+    std::string path = job.is_lib ? find_library_path(job) : job.name;
+    if (!path.empty()) {
+      paths[i] = get_host_path(ctx, path);
+      prefetch_file(paths[i], false);
+    }
+  });
+
+  tbb::parallel_for_each(paths, [&](std::string &path) {
+    if (!stop && !path.empty())
+      prefetch_file(path, true);
+  });
+}
+
+// An archive whose members are read only if needed. See
+// read_lazy_archive_members().
+struct LazyArchive {
+  std::vector<ReaderJob> members;
+  std::vector<std::pair<std::string_view, i64>> symtab;
+};
+
+// Calls `fn` with the names of symbols that may cause archive members
+// defining them to be linked, i.e. strong undefined and common symbols.
+template <typename E>
+static void for_each_symbol_ref(InputFile<E> *file, auto fn) {
+  for (i64 i = file->first_global; i < file->elf_syms.size(); i++) {
+    const ElfSym<E> &esym = file->elf_syms[i];
+    if (esym.is_undef() ? !esym.is_weak() : (!file->is_dso && esym.is_common()))
+      fn(file->is_dso ? file->symbol_strtab.data() + esym.st_name
+                      : file->get_symbol_name(i));
+  }
+}
+
+// With --lazy-archives, archives with a symbol index are not expanded
+// into their members up front. Instead, starting from references in
+// files we have already read, we look up each referenced symbol in the
+// archive indices and read the members defining it, which may in turn
+// refer to other symbols. Members are read in parallel as they are
+// found.
+//
+// We read all members that define a referenced symbol, not only the one
+// that symbol resolution would choose, because the index doesn't tell
+// whether a definition is weak. mark_live_objects() still decides which
+// of the members we read are linked. Since every member that can become
+// reachable is read, the result is the same as without this option.
+template <typename E>
+static void
+read_lazy_archive_members(Context<E> &ctx,
+                          tbb::concurrent_vector<LazyArchive> &archives) {
+  Timer t(ctx, "read_lazy_archive_members");
+
+  std::vector<ReaderJob *> members;
+  std::vector<std::pair<std::string_view, i64>> symtab;
+
+  for (LazyArchive &ar : archives) {
+    for (std::pair<std::string_view, i64> &ent : ar.symtab)
+      symtab.push_back({ent.first, ent.second + members.size()});
+    for (ReaderJob &job : ar.members)
+      members.push_back(&job);
+  }
+
+  // Build a map from symbol names to the members defining them. Each map
+  // value is the head of a linked list of `symtab` indices. A versioned
+  // name such as `foo@@VER` is registered as `foo`.
+  ConcurrentMap<Atomic<i32>> map(symtab.size() * 2);
+  std::vector<i32> next(symtab.size(), -1);
+
+  tbb::parallel_for((i64)0, (i64)symtab.size(), [&](i64 i) {
+    std::string_view name = symtab[i].first;
+    name = name.substr(0, name.find('@'));
+
+    auto [head, inserted] = map.insert(name, hash_string(name), i);
+    if (!inserted) {
+      i32 old = head->load();
+      do {
+        next[i] = old;
+      } while (!head->compare_exchange_weak(old, i));
+    }
+  });
+
+  std::vector<Atomic<bool>> is_read(members.size());
+
+  auto find_members = [&](std::string_view name, auto add) {
+    name = name.substr(0, name.find('@'));
+    if (Atomic<i32> *head = map.find(name, hash_string(name)))
+      for (i32 i = head->load(); i != -1; i = next[i])
+        if (!is_read[symtab[i].second].test_and_set())
+          add(symtab[i].second);
+  };
+
+  // --wrap redirects references to other names.
+  auto find_members_for_ref = [&](std::string_view name, auto add) {
+    find_members(name, add);
+    if (name.starts_with("__real_") && ctx.arg.wrap.contains(name.substr(7)))
+      find_members(name.substr(7), add);
+    else if (ctx.arg.wrap.contains(name))
+      find_members("__wrap_" + std::string(name), add);
+  };
+
+  // Find members needed by the files we have read so far and by
+  // command line options.
+  tbb::concurrent_vector<i64> roots;
+  auto add_root = [&](i64 i) { roots.push_back(i); };
+
+  tbb::parallel_for_each(ctx.unsorted_input_files, [&](auto &pair) {
+    InputFile<E> *file = pair.second;
+    if (file->is_dso || !file->to_obj()->is_lto_input)
+      for_each_symbol_ref(file, [&](std::string_view name) {
+        find_members_for_ref(name, add_root);
+      });
+  });
+
+  for (Symbol<E> *sym : ctx.arg.undefined)
+    find_members_for_ref(sym->name(), add_root);
+  for (Symbol<E> *sym : ctx.arg.require_defined)
+    find_members_for_ref(sym->name(), add_root);
+
+  for (i64 i = 0; i < ctx.arg.defsyms.size(); i++)
+    if (Symbol<E> **sym = std::get_if<Symbol<E> *>(&ctx.arg.defsyms[i].second))
+      find_members_for_ref((*sym)->name(), add_root);
+
+  if (!ctx.arg.undefined_glob.empty())
+    for (std::pair<std::string_view, i64> &ent : symtab)
+      if (ctx.arg.undefined_glob.find(ent.first) != -1 &&
+          !is_read[ent.second].test_and_set())
+        add_root(ent.second);
+
+  // Read needed members in parallel, following their references.
+  std::atomic_bool has_lto_obj = false;
+
+  tbb::parallel_for_each(roots, [&](i64 i, tbb::feeder<i64> &feeder) {
+    ReaderJob &job = *members[i];
+    ObjectFile<E> *file =
+      read_archive_member(ctx, job.rctx, job.mf, job.archive_name);
+
+    if (!file)
+      return;
+
+    if (file->is_lto_input) {
+      has_lto_obj = true;
+      return;
+    }
+
+    for_each_symbol_ref(file, [&](std::string_view name) {
+      find_members_for_ref(name, [&](i64 j) { feeder.add(j); });
+    });
+  });
+
+  for (auto &pair : ctx.unsorted_input_files)
+    if (!pair.second->is_dso && pair.second->to_obj()->is_lto_input)
+      has_lto_obj = true;
+
+  // The LTO result may refer to symbols that no IR file refers to, such
+  // as library functions that the code generator emits calls to. We
+  // can't tell which, so we read all remaining members.
+  if (has_lto_obj) {
+    tbb::parallel_for((i64)0, (i64)members.size(), [&](i64 i) {
+      if (!is_read[i].test_and_set())
+        read_archive_member(ctx, members[i]->rctx, members[i]->mf,
+                            members[i]->archive_name);
+    });
+  }
+
+  static Counter skipped("skipped_archive_members");
+  for (Atomic<bool> &flag : is_read)
+    if (!flag)
+      skipped++;
+}
+
 // Reads all input files.
 //
 // Reading input files is I/O- and CPU-intensive, and a large program
@@ -209,6 +461,14 @@ template <typename E>
 static void read_input_files(Context<E> &ctx, std::vector<ReaderJob> &jobs) {
   Timer t(ctx, "read_input_files");
 
+  // The number of major page faults tells how often we have stalled on
+  // cold input files, and "(stall)" in --perf tells how long. The latter
+  // is the time worker threads spent off CPU while reading files divided
+  // by the number of threads. With warm caches, it is close to zero.
+  static Counter major_faults("input_major_page_faults");
+  i64 faults = get_major_page_faults();
+  std::atomic<i64> stall_nsec = 0;
+
   // Open and read files in parallel. Archive files are expanded into
   // one job per member so that members are read in parallel too.
   //
@@ -229,9 +489,9 @@ static void read_input_files(Context<E> &ctx, std::vector<ReaderJob> &jobs) {
   // as SEARCH_DIR, which affects how -l arguments after it are
   // resolved, this scheme needs to be revisited.
   tbb::concurrent_vector<ReaderJob> scripts;
+  tbb::concurrent_vector<LazyArchive> lazy_archives;
 
-  tbb::parallel_for_each(jobs, [&](ReaderJob &job,
-                                   tbb::feeder<ReaderJob> &feeder) {
+  auto read = [&](ReaderJob &job, tbb::feeder<ReaderJob> &feeder) {
     ReaderContext &rctx = job.rctx;
 
     // An archive member is enqueued in an already-opened form by the
@@ -252,15 +512,27 @@ static void read_input_files(Context<E> &ctx, std::vector<ReaderJob> &jobs) {
 
     switch (get_file_type(ctx, mf)) {
     case FileType::AR:
-    case FileType::THIN_AR:
+    case FileType::THIN_AR: {
+      std::vector<ReaderJob> members;
       for (MappedFile *child : read_archive_members(ctx, mf)) {
         ReaderJob job2;
         job2.rctx = rctx.next_child();
         job2.mf = child;
         job2.archive_name = mf->name;
-        feeder.add(std::move(job2));
+        members.push_back(std::move(job2));
+      }
+
+      if (ctx.arg.lazy_archives && !rctx.whole_archive) {
+        if (auto symtab = read_archive_symtab(ctx, mf)) {
+          lazy_archives.push_back({std::move(members), std::move(*symtab)});
+          break;
+        }
       }
+
+      for (ReaderJob &job2 : members)
+        feeder.add(std::move(job2));
       break;
+    }
     case FileType::TEXT:
       job.mf = mf;
       scripts.push_back(std::move(job));
@@ -268,8 +540,26 @@ static void read_input_files(Context<E> &ctx, std::vector<ReaderJob> &jobs) {
     default:
       read_file(ctx, rctx, mf);
     }
+  };
+
+  tbb::parallel_for_each(jobs, [&](ReaderJob &job,
+                                   tbb::feeder<ReaderJob> &feeder) {
+    if (!ctx.arg.perf) {
+      read(job, feeder);
+      return;
+    }
+
+    i64 wall = now_nsec();
+    i64 cpu = get_thread_cpu_time();
+    read(job, feeder);
+    i64 stall = (now_nsec() - wall) - (get_thread_cpu_time() - cpu);
+    stall_nsec += std::max<i64>(stall, 0);
   });
 
+  if (ctx.arg.perf)
+    t.add_child(ctx, "(stall)",
+                stall_nsec / tbb::this_task_arena::max_concurrency());
+
   // Parse linker scripts and read the files they name.
   ranges::sort(scripts, {}, [](const ReaderJob &job) {
     return job.rctx.pos;
@@ -278,6 +568,10 @@ static void read_input_files(Context<E> &ctx, std::vector<ReaderJob> &jobs) {
   for (ReaderJob &job : scripts)
     Script(ctx, job.rctx, job.mf).parse_linker_script();
 
+  // Read archive members that are needed if --lazy-archives is given.
+  if (!lazy_archives.empty())
+    read_lazy_archive_members(ctx, lazy_archives);
+
   // Sort the files into the command line order and assign priorities.
   ranges::sort(ctx.unsorted_input_files, {},
                &std::pair<std::vector<u32>, InputFile<E> *>::first);
@@ -296,8 +590,10 @@ static void read_input_files(Context<E> &ctx, std::vector<ReaderJob> &jobs) {
 
   ctx.unsorted_input_files.clear();
 
-  if (ctx.objs.empty() && ctx.dsos.empty())
+  if (ctx.objs.empty() && ctx.dsos.empty() && lazy_archives.empty())
     Fatal(ctx) << "no input files";
+
+  major_faults += get_major_page_faults() - faults;
 }
 
 template <typename E>
@@ -373,9 +669,27 @@ int mold_main(int argc, char **argv) {
   for (std::string_view arg : ctx.arg.trace_symbol)
     get_symbol(ctx, arg)->is_traced = true;
 
+  // List library search directories if we need to search for libraries.
+  if (ranges::any_of(jobs, &ReaderJob::is_lib))
+    index_library_paths(ctx);
+
+  // Read input files into the page cache in the background.
+  std::atomic_bool stop_prefetch = false;
+  tbb::task_arena prefetch_arena(tbb::task_arena::automatic, 1,
+                                 tbb::task_arena::priority::low);
+  tbb::task_group prefetch_task;
+  prefetch_arena.execute([&] {
+    prefetch_task.run([&ctx, &stop_prefetch, jobs] {
+      prefetch_input_files(ctx, jobs, stop_prefetch);
+    });
+  });
+
   // Parse input files
   read_input_files(ctx, jobs);
 
+  stop_prefetch = true;
+  prefetch_arena.execute([&] { prefetch_task.wait(); });
+
   // Uniquify shared object files by soname
   {
     std::unordered_set<std::string_view> seen;
@@ -403,9 +717,25 @@ int mold_main(int argc, char **argv) {
   resolve_symbols(ctx);
 
   // If there's an object file compiled with -flto, do link-time
-  // optimization.
-  if (has_lto_obj(ctx))
+  // optimization. Meanwhile, we preprocess regular object files in the
+  // background.
+  if (has_lto_obj(ctx)) {
+    // We select files on this thread because do_lto() mutates
+    // `is_reachable`. For object files, `as_needed` is set for archive
+    // members and --start-lib files, which LTO may make unnecessary.
+    std::vector<ObjectFile<E> *> objs = ctx.objs;
+    std::erase_if(objs, [](ObjectFile<E> *file) {
+      return !file->is_reachable || file->is_lto_input || file->as_needed ||
+             !file->sections_parsed;
+    });
+
+    tbb::task_group lto_task;
+    lto_task.run([&ctx, objs = std::move(objs)] {
+      preprocess_non_lto_objects(ctx, objs);
+    });
     do_lto(ctx);
+    lto_task.wait();
+  }
 
   // Now that we know which object files are to be included to the
   // final output, we can remove unnecessary files.
@@ -438,7 +768,7 @@ int mold_main(int argc, char **argv) {
   // from the normal one when the option is given, the logic is implemented
   // to a separate file.
   if (ctx.arg.relocatable) {
-    combine_objects(ctx);
+    combine_objects(ctx, t_before_copy);
     return 0;
   }
 
@@ -552,6 +882,10 @@ int mold_main(int argc, char **argv) {
   if (ctx.arg.shuffle_sections != SHUFFLE_SECTIONS_NONE)
     shuffle_sections(ctx);
 
+  // Handle --hot-data-file
+  if (!ctx.arg.hot_data_symbols.empty())
+    sort_hot_data_sections(ctx);
+
   // Copy string referred by .dynamic to .dynstr.
   add_dynamic_strings(ctx);
 
@@ -675,6 +1009,13 @@ int mold_main(int argc, char **argv) {
 
   // At this point, memory layout is fixed.
 
+  // CREL relocation sections for --emit-relocs contain addresses in
+  // a variable-length encoding, so we can compute their sizes only now.
+  if (ctx.arg.emit_relocs && ctx.arg.z_crel) {
+    compute_crel_sizes(ctx);
+    filesize = set_osec_offsets(ctx);
+  }
+
   // Set actual addresses to linker-synthesized symbols.
   fix_synthetic_symbols(ctx);
 
@@ -29,6 +29,85 @@ MappedFile *open_file_impl(const std::string &path, std::string &error) {
   return mf;
 }
 
+// Asks the kernel to start reading the parts of a file that the input
+// file reader touches first into the page cache, so that the reader
+// doesn't stall on page faults one page at a time.
+//
+// If `read_headers` is false, we only request the first page, which
+// doesn't block. Otherwise, we read the ELF header and the section
+// header table to request the exact ranges of the section name table
+// and symbol tables. For an archive, we request its symbol index.
+void prefetch_file(const std::string &path, bool read_headers) {
+#ifdef POSIX_FADV_WILLNEED
+  i64 fd = ::open(path.c_str(), O_RDONLY);
+  if (fd == -1)
+    return;
+
+  auto advise = [&](u64 offset, u64 size) {
+    posix_fadvise(fd, offset, size, POSIX_FADV_WILLNEED);
+  };
+
+  auto pread_full = [&](void *buf, u64 size, u64 offset) {
+    return pread(fd, buf, size, offset) == (i64)size;
+  };
+
+  u8 ehdr[64];
+
+  if (!read_headers) {
+    advise(0, 4096);
+  } else if (pread_full(ehdr, 60, 0) &&
+             (!memcmp(ehdr, "!<arch>\n", 8) || !memcmp(ehdr, "!<thin>\n", 8))) {
+    // The first member is usually the symbol index. Its size field is
+    // at offset 48 of the 60-byte member header.
+    advise(8, 60 + atol(std::string((char *)ehdr + 8 + 48, 10).c_str()));
+  } else if (pread_full(ehdr, 64, 0) && !memcmp(ehdr, "\177ELF", 4)) {
+    bool is_64 = (ehdr[4] == ELFCLASS64);
+    bool is_le = (ehdr[5] == ELFDATA2LSB);
+
+    auto get = [&](u8 *p, i64 size) {
+      u64 val = 0;
+      for (i64 i = 0; i < size; i++)
+        val |= (u64)p[is_le ? i : size - i - 1] << (i * 8);
+      return val;
+    };
+
+    u64 shoff = is_64 ? get(ehdr + 40, 8) : get(ehdr + 32, 4);
+    u64 shentsize = is_64 ? get(ehdr + 58, 2) : get(ehdr + 46, 2);
+    u64 shnum = is_64 ? get(ehdr + 60, 2) : get(ehdr + 48, 2);
+    u64 shstrndx = is_64 ? get(ehdr + 62, 2) : get(ehdr + 50, 2);
+
+    std::vector<u8> shdrs;
+    if (shentsize == (is_64 ? 64 : 40))
+      shdrs.resize(shnum * shentsize);
+
+    if (!shdrs.empty() && pread_full(shdrs.data(), shdrs.size(), shoff)) {
+      auto advise_section = [&](u64 idx) {
+        if (idx >= shnum)
+          return;
+        u8 *p = shdrs.data() + idx * shentsize;
+        if (is_64)
+          advise(get(p + 24, 8), get(p + 32, 8));
+        else
+          advise(get(p + 16, 4), get(p + 20, 4));
+      };
+
+      advise_section(shstrndx);
+
+      for (u64 i = 0; i < shnum; i++) {
+        u8 *p = shdrs.data() + i * shentsize;
+        u64 type = get(p + 4, 4);
+        if (type == SHT_SYMTAB || type == SHT_DYNSYM) {
+          advise_section(i);
+          advise_section(get(p + (is_64 ? 40 : 24), 4));
+        }
+      }
+    }
+  }
+
+  close(fd);
+#endif
+}
+
 void MappedFile::unmap() {
   if (size == 0 || parent || !data)
     return;
@@ -53,6 +53,10 @@ MappedFile *open_file_impl(const std::string &path, std::string &error) {
   return mf;
 }
 
+// There's no cheap way to hint the OS about upcoming file reads
+// without mapping the file, so we don't prefetch input files on Windows.
+void prefetch_file(const std::string &path, bool read_headers) {}
+
 void MappedFile::unmap() {
   if (size == 0 || parent || !data)
     return;
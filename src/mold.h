@@ -240,11 +240,18 @@ public:
 };
 
 MappedFile *open_file_impl(const std::string &path, std::string &error);
+void prefetch_file(const std::string &path, bool read_headers);
 
 template <typename E>
-MappedFile *open_file(Context<E> &ctx, std::string path) {
+std::string get_host_path(Context<E> &ctx, std::string path) {
   if (path.starts_with('/') && !ctx.arg.chroot.empty())
-    path = ctx.arg.chroot + "/" + path_clean(path);
+    return ctx.arg.chroot + "/" + path_clean(path);
+  return path;
+}
+
+template <typename E>
+MappedFile *open_file(Context<E> &ctx, std::string path) {
+  path = get_host_path(ctx, path);
 
   std::string error;
   MappedFile *mf = open_file_impl(path, error);
@@ -302,6 +309,9 @@ struct __attribute__((aligned(4))) SectionFragment {
   // True if this fragment must be placed within 2^32 bytes from the
   // start of the output section.
   Atomic<bool> is_32bit = false;
+
+  // True if this string is stored as the tail of another string.
+  bool is_tail_merged = false;
 };
 
 // Additional class members for dynamic symbols. Because most symbols
@@ -522,7 +532,19 @@ struct InputSectionExtras<E> {
   ArenaPtr<InputSection<E>> exidx;
 };
 
+// On x86-64, scan_relocations() records what apply_reloc_alloc() has
+// to do for each relocation as a one-byte action so that the common
+// relocations don't have to be decoded again. The array is allocated
+// from the arena and is null if the link-wide size limit was exceeded,
+// in which case apply_reloc_alloc() decodes relocations as usual.
+template <is_x86_64 E>
+struct InputSectionExtras<E> {
+  ArenaPtr<u8> reloc_actions;
+};
+
 struct RelocDelta {
+  bool operator==(const RelocDelta &) const = default;
+
   u64 offset;
   i64 delta;
 };
@@ -536,10 +558,11 @@ struct RelocDelta {
 // `delta` bytes when copying section contents to the output buffer.
 //
 // Since code-shrinking relaxation never bloats section contents, `delta`
-// increases monotonically within the array as well.
+// increases monotonically within the array as well. In other words,
+// `delta` is a prefix sum of the bytes removed so far in the section.
 //
-// The array is written once by shrink_section() and lives in the arena so
-// that InputSection stays trivially destructible.
+// The array is rewritten by each shrink_section() pass and lives in the
+// arena so that InputSection stays trivially destructible.
 template <typename E> requires is_riscv<E> || is_loongarch<E>
 struct InputSectionExtras<E> {
   std::span<RelocDelta> r_deltas;
@@ -693,6 +716,13 @@ u64 get_eflags(Context<E> &ctx) {
 template <typename E>
 i64 to_phdr_flags(Context<E> &ctx, Chunk<E> *chunk);
 
+// -z hugepage-text places hot text in its own segment which is aligned
+// and padded to this size, so that it can be backed by huge pages.
+constexpr i64 HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+template <typename E>
+bool is_hugepage_text(Context<E> &ctx, Chunk<E> *chunk);
+
 template <typename E>
 void write_plt_header(Context<E> &ctx, u8 *buf);
 
@@ -860,10 +890,9 @@ public:
 
   std::span<ArenaPtr<InputSection<E>>> members;
 
-  // Scratch buffer used by create_output_sections() to build `members`.
-  // Grouping input sections by file allows appending them in parallel
-  // without synchronization while keeping their order deterministic.
-  std::vector<std::vector<InputSection<E> *>> members_vec;
+  // Scratch fields used by create_output_sections() to build `members`.
+  i64 num_members = 0;
+  Atomic<u8> p2align = 0;
 
   std::vector<std::unique_ptr<Thunk<E>>> thunks;
   std::unique_ptr<RelocSection<E>> reloc_sec;
@@ -892,10 +921,7 @@ public:
     this->shdr.sh_size = (is_s390x<E> ? 3 : 1) * sizeof(Word<E>);
   }
 
-  void add_got_symbol(Context<E> &ctx, Symbol<E> *sym);
-  void add_gottp_symbol(Context<E> &ctx, Symbol<E> *sym);
-  void add_tlsgd_symbol(Context<E> &ctx, Symbol<E> *sym);
-  void add_tlsdesc_symbol(Context<E> &ctx, Symbol<E> *sym);
+  void add_symbols(Context<E> &ctx, const std::vector<Symbol<E> *> &syms);
   void add_tlsld(Context<E> &ctx);
 
   u64 get_tlsld_addr(Context<E> &ctx) const;
@@ -955,7 +981,7 @@ public:
     }
   }
 
-  void add_symbol(Context<E> &ctx, Symbol<E> *sym);
+  void add_symbols(Context<E> &ctx, const std::vector<Symbol<E> *> &syms);
   void update_shdr(Context<E> &ctx) override;
   void copy_buf(Context<E> &ctx) override;
 
@@ -979,7 +1005,7 @@ public:
     this->shdr.sh_addralign = 16;
   }
 
-  void add_symbol(Context<E> &ctx, Symbol<E> *sym);
+  void add_symbols(Context<E> &ctx, const std::vector<Symbol<E> *> &syms);
   void copy_buf(Context<E> &ctx) override;
 
   void compute_symtab_size(Context<E> &ctx) override;
@@ -1129,10 +1155,18 @@ public:
 
   i64 add_string(std::string_view str);
   i64 find_string(std::string_view str);
+  void add_dynsym_names(Context<E> &ctx);
   void copy_buf(Context<E> &ctx) override;
 
+  // .dynstr offsets of .dynsym symbol names indexed by dynsym index
+  std::vector<u32> dynsym_offsets;
+
 private:
   std::unordered_map<std::string_view, i64> strings;
+
+  // The dynsym index of a symbol whose name contains each symbol's name
+  // at its end. A name is stored in .dynstr only if it is its own owner.
+  std::vector<u32> dynsym_owners;
 };
 
 // .dynamic contains various information for dynamically-linked ELF files.
@@ -1215,11 +1249,11 @@ public:
   }
 
   void add_symbol(Context<E> &ctx, Symbol<E> *sym);
+  void add_symbols(Context<E> &ctx, const std::vector<Symbol<E> *> &syms);
   void update_shdr(Context<E> &ctx) override;
   void copy_buf(Context<E> &ctx) override;
 
   std::vector<Symbol<E> *> symbols;
-  i64 dynstr_offset = -1;
 };
 
 // .hash contains an on-disk hash table for .dynsym so that the runtime
@@ -1268,7 +1302,6 @@ public:
   void update_shdr(Context<E> &ctx) override;
   void copy_buf(Context<E> &ctx) override;
 
-  static constexpr i64 LOAD_FACTOR = 8;
   static constexpr i64 HEADER_SIZE = 16;
   static constexpr i64 BLOOM_SHIFT = 26;
 
@@ -1303,9 +1336,15 @@ public:
   bool resolved = false;
 
 private:
+  using Entry = typename ConcurrentMap<SectionFragment<E>>::Entry;
+
   MergedSection(std::string_view name, i64 flags, i64 type, i64 entsize);
+  void tail_merge_strings(Context<E> &ctx);
 
   std::vector<i64> shard_offsets;
+
+  // Pairs of a tail-merged string and the string that contains it
+  std::vector<std::pair<Entry *, Entry *>> tail_merged;
 };
 
 // .eh_frame contains runtime information as to how to handle exceptions
@@ -1349,6 +1388,9 @@ public:
   void copy_buf(Context<E> &ctx) override;
 
   i64 num_fdes = 0;
+
+private:
+  void write_table(Context<E> &ctx, u8 *buf);
 };
 
 // EhFrameRelocSection contains relcoation records for .eh_frame. We use
@@ -1617,10 +1659,14 @@ public:
   void update_shdr(Context<E> &ctx) override;
   void copy_buf(Context<E> &ctx) override;
   RelocSection<E> *to_reloc_sec() override { return this; }
+  void compute_crel_size(Context<E> &ctx);
 
 private:
+  void copy_crel(Context<E> &ctx);
+
   OutputSection<E> &output_section;
   std::vector<i64> offsets;
+  u64 crel_hdr = 0;
 };
 
 // PT_GNU_RELRO works on page granularity. We want to align its end to
@@ -1681,6 +1727,17 @@ public:
   // `buf` and `ctx.buf` may move as a result of this call.
   virtual u8 *extend(Context<E> &ctx, i64 size) = 0;
 
+  // Zero-clears a given range of the buffer. Returns false if the range
+  // was left untouched because it is known to be zero already. We call
+  // this for paddings between chunks, which can be large, so we don't
+  // want to dirty pages for nothing.
+  virtual bool clear(Context<E> &ctx, i64 offset, i64 size) {
+    if (is_zero_filled)
+      return false;
+    memset(buf + offset, 0, size);
+    return true;
+  }
+
   u8 *buf = nullptr;
   std::string path;
   int fd = -1;
@@ -1688,6 +1745,10 @@ public:
   bool is_mmapped = false;
   bool is_unmapped = false;
 
+  // True if the buffer was zero-filled when created, which is the case
+  // for a freshly-created file.
+  bool is_zero_filled = false;
+
 protected:
   OutputFile(std::string path, i64 filesize, bool is_mmapped)
     : path(path), filesize(filesize), is_mmapped(is_mmapped) {}
@@ -1701,6 +1762,7 @@ public:
     this->buf = (u8 *)calloc(filesize, 1);
     if (!this->buf)
       Fatal(ctx) << "calloc failed: " << errno_string();
+    this->is_zero_filled = true;
   }
 
   ~MallocOutputFile() { free(this->buf); }
@@ -2009,8 +2071,11 @@ public:
   void read_section_metadata(Context<E> &ctx);
   void parse_sections(Context<E> &ctx, bool keep_discarded_comdat);
   void register_global_symbols(Context<E> &ctx);
+  void read_ehframe_records(Context<E> &ctx);
   void parse_ehframe(Context<E> &ctx);
   void parse_sframe(Context<E> &ctx) requires supports_sframe<E>;
+  void synthesize_sframe(Context<E> &ctx) requires supports_sframe<E>;
+  void split_mergeable_sections(Context<E> &ctx);
   void convert_mergeable_sections(Context<E> &ctx);
   void reattach_section_pieces(Context<E> &ctx);
   void resolve_symbols(Context<E> &ctx) override;
@@ -2040,18 +2105,20 @@ public:
 
   std::vector<InputSection<E> *> eh_frame_sections;
   std::vector<InputSection<E> *> sframe_sections;
+  std::vector<std::pair<i64, std::unique_ptr<MergeableSection<E>>>> split_sections;
   std::vector<SFrameFde<E>> sframe_fdes;
+  std::vector<std::string> sframe_failures;
   std::vector<ExactArray<ElfRel<E>>> decoded_crel;
   bool exclude_libs = false;
   std::map<u32, u32> gnu_properties;
   bool needs_executable_stack = false;
   bool is_lto_input = false;  // an IR file claimed by the LTO plugin
+  bool is_lto_claim_deferred = false; // symbols were read without the plugin
   bool is_lto_output = false; // an ELF file generated by the LTO plugin
   bool is_gcc_offload_obj = false;
   bool is_rust_obj = false;
   bool is_dwarf32 = false;
 
-  i64 fde_idx = 0;
   i64 fde_offset = 0;
   i64 fde_size = 0;
 
@@ -2094,7 +2161,9 @@ public:
 template <typename E>
 class SharedFile : public InputFile<E> {
 public:
-  SharedFile(Context<E> &ctx, MappedFile *mf) : InputFile<E>(ctx, mf) {}
+  SharedFile(Context<E> &ctx, MappedFile *mf)
+    : InputFile<E>(ctx, mf),
+      symbols2(ArenaAllocator<ArenaPtr<Symbol<E>>>(ctx.arena)) {}
 
   void parse(Context<E> &ctx);
   void resolve_symbols(Context<E> &ctx) override;
@@ -2112,7 +2181,7 @@ public:
 
   std::string soname;
   std::vector<std::string_view> version_strings;
-  std::vector<Symbol<E> *> symbols2;
+  std::vector<ArenaPtr<Symbol<E>>, ArenaAllocator<ArenaPtr<Symbol<E>>>> symbols2;
   std::vector<ElfSym<E>> elf_syms2;
 
 private:
@@ -2245,6 +2314,10 @@ template <typename E>
 std::vector<MappedFile *>
 read_archive_members(Context<E> &ctx, MappedFile *mf);
 
+template <typename E>
+std::optional<std::vector<std::pair<std::string_view, i64>>>
+read_archive_symtab(Context<E> &ctx, MappedFile *mf);
+
 //
 // lto.cc
 //
@@ -2268,11 +2341,57 @@ inline i64 get_removed_bytes(std::span<RelocDelta> deltas, i64 i) {
   return deltas[i].delta - deltas[i - 1].delta;
 }
 
+// shrink_sections() may scan the same section more than once. This class
+// returns the number of bytes that the previous scan removed at a given
+// relocation offset so that a later scan can tell whether a relaxation
+// is new or undone. Offsets must be given in ascending order, and each
+// record is returned only once.
+class RelocDeltaCursor {
+public:
+  RelocDeltaCursor(std::span<RelocDelta> deltas) : deltas(deltas) {}
+
+  i64 get_removed_bytes(u64 offset) {
+    while (idx < deltas.size() && deltas[idx].offset < offset)
+      idx++;
+    if (idx < deltas.size() && deltas[idx].offset == offset)
+      return mold::get_removed_bytes(deltas, idx++);
+    return 0;
+  }
+
+private:
+  std::span<RelocDelta> deltas;
+  i64 idx = 0;
+};
+
+// For --stats. The number of sites relaxed in each shrink_sections() pass.
+struct RelaxCounters {
+  RelaxCounters(i64 pass)
+    : calls_name("relaxed_calls_pass" + std::to_string(pass)),
+      hi20_name("relaxed_hi20_pass" + std::to_string(pass)),
+      calls(calls_name), hi20(hi20_name) {}
+
+  std::string calls_name;
+  std::string hi20_name;
+  Counter calls;
+  Counter hi20;
+};
+
 template <typename E>
 void shrink_sections(Context<E> &ctx);
 
+struct ShrinkResult {
+  // True if r_deltas differ from the ones computed by the previous pass.
+  bool changed = false;
+
+  // True if the section contains a relocation whose relaxability depends
+  // on the section layout, so that the section has to be scanned again
+  // if the layout changes.
+  bool needs_rescan = false;
+};
+
 template <typename E>
-void shrink_section(Context<E> &ctx, InputSection<E> &isec);
+ShrinkResult shrink_section(Context<E> &ctx, InputSection<E> &isec,
+                            RelaxCounters &counters, bool undo_only);
 
 template <typename E>
 i64 get_r_delta(InputSection<E> &isec, u64 offset);
@@ -2300,7 +2419,7 @@ void icf_sections(Context<E> &ctx);
 //
 
 template <typename E>
-void combine_objects(Context<E> &ctx);
+void combine_objects(Context<E> &ctx, Timer<Context<E>> &t_before_copy);
 
 //
 // mapfile.cc
@@ -2347,6 +2466,9 @@ template <typename E> void resolve_symbols(Context<E> &);
 template <typename E> void do_lto(Context<E> &);
 template <typename E> void parse_eh_frame_sections(Context<E> &);
 template <typename E> void parse_sframe_sections(Context<E> &);
+template <typename E>
+void preprocess_non_lto_objects(Context<E> &,
+                                const std::vector<ObjectFile<E> *> &);
 template <typename E> void create_merged_sections(Context<E> &);
 template <typename E> void convert_common_symbols(Context<E> &);
 template <typename E> void create_output_sections(Context<E> &);
@@ -2364,6 +2486,7 @@ template <typename E> void sort_init_fini(Context<E> &);
 template <typename E> void sort_ctor_dtor(Context<E> &);
 template <typename E> void fixup_ctors_in_init_array(Context<E> &);
 template <typename E> void shuffle_sections(Context<E> &);
+template <typename E> void sort_hot_data_sections(Context<E> &);
 template <typename E> void add_dynamic_strings(Context<E> &);
 template <typename E> void compute_section_sizes(Context<E> &);
 template <typename E> void sort_output_sections(Context<E> &);
@@ -2375,6 +2498,7 @@ template <typename E> void sort_debug_info_sections(Context<E> &);
 template <typename E> void create_output_symtab(Context<E> &);
 template <typename E> void report_undef_errors(Context<E> &);
 template <typename E> void create_reloc_sections(Context<E> &);
+template <typename E> void compute_crel_sizes(Context<E> &);
 template <typename E> void copy_chunks(Context<E> &);
 template <typename E> void apply_version_script(Context<E> &);
 template <typename E> void parse_symbol_version(Context<E> &);
@@ -2585,6 +2709,7 @@ struct ContextExtras {};
 template <is_x86 E>
 struct ContextExtras<E> {
   NotePropertySection<E> *note_property = nullptr;
+  Atomic<i64> num_reloc_actions = 0;
 };
 
 template <is_arm32 E>
@@ -2684,6 +2809,7 @@ struct Context {
     bool icf = false;
     bool icf_all = false;
     bool ignore_data_address_equality = false;
+    bool lazy_archives = false;
     bool lto_pass2 = false;
     bool nmagic = false;
     bool noinhibit_exec = false;
@@ -2709,6 +2835,7 @@ struct Context {
     bool strip_all = false;
     bool strip_debug = false;
     bool suppress_warnings = false;
+    bool synthesize_sframe = false;
     bool trace = false;
     bool undefined_version = false;
     bool use_android_relr_tags = false;
@@ -2716,12 +2843,14 @@ struct Context {
     bool warn_once = false;
     bool warn_textrel = false;
     bool z_copyreloc = true;
+    bool z_crel = false;
     bool z_delete = true;
     bool z_dlopen = true;
     bool z_dump = true;
     bool z_dynamic_undefined_weak = true;
     bool z_execstack = false;
     bool z_execstack_if_needed = false;
+    bool z_hugepage_text = false;
     bool z_ibt = false;
     bool z_initfirst = false;
     bool z_interpose = false;
@@ -2740,8 +2869,11 @@ struct Context {
     i64 compress_debug_sections = ELFCOMPRESS_NONE;
     i64 compress_debug_sections_level = 0;
     i64 filler = -1;
+    i64 hash_bloom_bits = 12;
+    i64 hash_load_factor = 8;
     i64 spare_dynamic_tags = 5;
     i64 spare_program_headers = 0;
+    i64 tail_merge_strings = 0;
     i64 z_stack_size = 0;
     std::optional<i64> thread_count;
     std::optional<std::vector<Symbol<E> *>> retain_symbols_file;
@@ -2759,6 +2891,7 @@ struct Context {
     std::string plugin;
     std::string print_gc_sections;
     std::string print_icf_sections;
+    std::string print_sframe_failures;
     std::string rpaths;
     std::string separate_debug_file;
     std::string soname;
@@ -2774,6 +2907,7 @@ struct Context {
     std::vector<Symbol<E> *> require_defined;
     std::vector<Symbol<E> *> undefined;
     std::vector<std::pair<Symbol<E> *, std::variant<Symbol<E> *, u64>>> defsyms;
+    std::vector<std::pair<Symbol<E> *, bool>> hot_data_symbols;
     std::vector<std::string> library_paths;
     std::vector<std::string> plugin_opt;
     std::vector<std::string> version_definitions;
@@ -2809,6 +2943,17 @@ struct Context {
   ArenaResource arena;
   ShardedMap<Symbol<E>> symbol_map;
 
+  // Demangled names of symbols in `symbol_map`, indexed by shard number
+  // and position within the shard. Each entry is an arena index of a
+  // NUL-terminated string, or 0 if the name is not a mangled C++ name.
+  // Filled lazily the first time C++ patterns are matched.
+  std::vector<u32> demangled_names[ShardedMap<Symbol<E>>::NUM_SHARDS];
+
+  // Symbols matched by wildcard or C++ patterns of --dynamic-list and
+  // the like. Computed by apply_version_script() in the same walk as
+  // version patterns and consumed by compute_import_export().
+  std::vector<Symbol<E> *> dynamic_list_syms;
+
   tbb::concurrent_vector<ArenaObjectPtr<MergedSection<E>>> merged_sections;
 
   tbb::concurrent_vector<std::unique_ptr<TimerRecord>> timer_records;
@@ -2823,6 +2968,11 @@ struct Context {
   // Fully-expanded command line args
   std::vector<std::string_view> cmdline_args;
 
+  // Names of files in each library search directory, in the same order
+  // as `arg.library_paths`. std::nullopt if a directory couldn't be
+  // listed. Empty if we haven't listed the directories.
+  std::vector<std::optional<std::unordered_set<std::string>>> library_path_files;
+
   // Input files
   std::vector<ObjectFile<E> *> objs;
   std::vector<SharedFile<E> *> dsos;
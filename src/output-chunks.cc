@@ -5,6 +5,7 @@
 #include <shared_mutex>
 #include <span>
 #include <tbb/parallel_for_each.h>
+#include <tbb/parallel_invoke.h>
 #include <tbb/parallel_scan.h>
 #include <tbb/parallel_sort.h>
 
@@ -29,6 +30,73 @@ static u32 elf_hash(std::string_view name) {
   return h;
 }
 
+// Sorts strings by their reversed contents in descending order. Strings
+// in a string table tend to share long suffixes (e.g. "EEE\0" of mangled
+// names), so we use multikey quicksort, which looks at each character
+// only once instead of comparing common suffixes over and over again.
+// Characters are compared eight at a time; `key` caches the eight
+// characters at `pos` from the end of each string so that partitioning
+// doesn't have to touch the strings themselves.
+template <typename Entry>
+struct ReversedStringSortKey {
+  ReversedStringSortKey() = default;
+  ReversedStringSortKey(Entry *ent) : ent(ent) { load(0); }
+
+  // `key` is a pair of the characters and the number of characters, so
+  // that a string that has ended is smaller than any other string.
+  void load(i64 pos) {
+    i64 len = std::clamp<i64>(ent->keylen - pos, 0, 8);
+    u64 word = 0;
+    for (i64 i = 0; i < len; i++)
+      word |= (u64)(u8)ent->key[ent->keylen - pos - i - 1] << (56 - i * 8);
+    key = {word, len};
+  }
+
+  Entry *ent;
+  std::pair<u64, i64> key;
+};
+
+template <typename Entry>
+static void
+sort_by_reversed_contents(std::span<ReversedStringSortKey<Entry>> vec, i64 pos) {
+  while (vec.size() > 1) {
+    // Partition strings into ones whose characters at `pos` are greater
+    // than, equal to and less than the pivot's.
+    auto pivot = vec[vec.size() / 2].key;
+    i64 lo = 0;
+    i64 hi = vec.size();
+
+    for (i64 i = 0; i < hi;) {
+      if (vec[i].key > pivot)
+        std::swap(vec[lo++], vec[i++]);
+      else if (vec[i].key < pivot)
+        std::swap(vec[i], vec[--hi]);
+      else
+        i++;
+    }
+
+    auto sort_gt = [&] { sort_by_reversed_contents(vec.subspan(0, lo), pos); };
+    auto sort_lt = [&] { sort_by_reversed_contents(vec.subspan(hi), pos); };
+
+    if (vec.size() > 10000) {
+      tbb::parallel_invoke(sort_gt, sort_lt);
+    } else {
+      sort_gt();
+      sort_lt();
+    }
+
+    // If the pivot has ended, all strings in the middle partition are
+    // identical to it.
+    if (pivot.second == 0)
+      return;
+
+    vec = vec.subspan(lo, hi - lo);
+    pos += 8;
+    for (ReversedStringSortKey<Entry> &x : vec)
+      x.load(pos);
+  }
+}
+
 template <typename E>
 Chunk<E> *find_chunk(Context<E> &ctx, u32 sh_type) {
   for (Chunk<E> *chunk : ctx.chunks)
@@ -151,6 +219,14 @@ i64 to_phdr_flags(Context<E> &ctx, Chunk<E> *chunk) {
   return PF_R | (write ? PF_W : PF_NONE) | (exec ? PF_X : PF_NONE);
 }
 
+// Returns true if a given chunk is hot text for -z hugepage-text.
+// .text.hot exists only if -z keep-text-section-prefix is given.
+template <typename E>
+bool is_hugepage_text(Context<E> &ctx, Chunk<E> *chunk) {
+  return ctx.arg.z_hugepage_text && chunk->to_osec() &&
+         (chunk->name == ".text" || chunk->name == ".text.hot");
+}
+
 template <typename E>
 static std::vector<ElfPhdr<E>> create_phdr(Context<E> &ctx) {
   std::vector<ElfPhdr<E>> vec;
@@ -249,10 +325,22 @@ static std::vector<ElfPhdr<E>> create_phdr(Context<E> &ctx) {
       while (i < chunks.size() &&
              !is_bss(chunks[i]) &&
              to_phdr_flags(ctx, chunks[i]) == flags &&
+             is_hugepage_text(ctx, chunks[i]) ==
+             is_hugepage_text(ctx, first) &&
              chunks[i]->shdr.sh_offset - first->shdr.sh_offset ==
              chunks[i]->shdr.sh_addr - first->shdr.sh_addr)
         append(chunks[i++]);
 
+    // Hot text for -z hugepage-text gets its own segment that covers
+    // whole huge pages. set_file_offsets() has reserved the file space
+    // for the padding.
+    if (is_hugepage_text(ctx, first)) {
+      ElfPhdr<E> &phdr = vec.back();
+      phdr.p_align = std::max<u64>(phdr.p_align, HUGE_PAGE_SIZE);
+      phdr.p_memsz = align_to(phdr.p_memsz, HUGE_PAGE_SIZE);
+      phdr.p_filesz = phdr.p_memsz;
+    }
+
     while (i < chunks.size() &&
            is_bss(chunks[i]) &&
            to_phdr_flags(ctx, chunks[i]) == flags)
@@ -550,17 +638,36 @@ void StrtabSection<E>::copy_buf(Context<E> &ctx) {
       memcpy(buf + 1, "$a\0$t\0$d", 9);
 }
 
+// Section names are deduplicated. With -r, there can be hundreds of
+// thousands of output sections, so we find duplicates in parallel using
+// a concurrent hash table instead of a serial one.
 template <typename E>
 void ShstrtabSection<E>::update_shdr(Context<E> &ctx) {
-  std::unordered_map<std::string_view, i64> map;
-  i64 offset = 1;
+  std::vector<Chunk<E> *> chunks;
+  for (Chunk<E> *chunk : ctx.chunks)
+    if (!chunk->is_header() && !chunk->name.empty())
+      chunks.push_back(chunk);
 
-  for (Chunk<E> *chunk : ctx.chunks) {
-    if (!chunk->is_header() && !chunk->name.empty()) {
-      auto [it, inserted] = map.insert({chunk->name, offset});
-      chunk->shdr.sh_name = it->second;
-      if (inserted)
-        offset += chunk->name.size() + 1;
+  // Each entry holds the index of the first chunk having that name.
+  ConcurrentMap<Atomic<i32>> map(chunks.size() * 2);
+  std::vector<Atomic<i32> *> leaders(chunks.size());
+
+  tbb::parallel_for((i64)0, (i64)chunks.size(), [&](i64 i) {
+    std::string_view name = chunks[i]->name;
+    Atomic<i32> *ent = map.insert(name, hash_string(name), i).first;
+    update_minimum(*ent, i);
+    leaders[i] = ent;
+  });
+
+  // Names are laid out in the order of their first appearance.
+  i64 offset = 1;
+  for (i64 i = 0; i < chunks.size(); i++) {
+    i64 j = *leaders[i];
+    if (i == j) {
+      chunks[i]->shdr.sh_name = offset;
+      offset += chunks[i]->name.size() + 1;
+    } else {
+      chunks[i]->shdr.sh_name = chunks[j]->shdr.sh_name;
     }
   }
 
@@ -597,6 +704,92 @@ i64 DynstrSection<E>::find_string(std::string_view str) {
   return it->second;
 }
 
+// Assigns .dynstr offsets to .dynsym symbol names. The names are placed
+// after the strings added by add_string() in the .dynsym order. A name
+// identical to another name, or a suffix of another name if
+// --tail-merge-strings is given, refers to that name instead of being
+// stored separately.
+//
+// Identical names are not rare because versioned symbols such as foo@v1
+// and foo@@v2 share the same name.
+template <typename E>
+void DynstrSection<E>::add_dynsym_names(Context<E> &ctx) {
+  std::span<Symbol<E> *> syms = ctx.dynsym->symbols;
+
+  struct Name {
+    const char *key;
+    i64 keylen;
+  };
+
+  std::vector<Name> names(syms.size());
+  std::vector<ReversedStringSortKey<Name>> keys(syms.size() - 1);
+
+  tbb::parallel_for((i64)1, (i64)syms.size(), [&](i64 i) {
+    std::string_view name = syms[i]->name();
+    names[i] = {name.data(), (i64)name.size()};
+    keys[i - 1] = {&names[i]};
+  });
+
+  // As in MergedSection::tail_merge_strings(), we merge a name into its
+  // immediate predecessor after sorting if the predecessor ends with it.
+  // Identical names are always merged. Otherwise, both names have to be
+  // at most --tail-merge-strings bytes long, which is the same limit as
+  // for mergeable string sections.
+  sort_by_reversed_contents<Name>(keys, 0);
+
+  std::vector<u8> is_merged(keys.size());
+  i64 max_len = ctx.arg.tail_merge_strings;
+
+  tbb::parallel_for((i64)1, (i64)keys.size(), [&](i64 i) {
+    std::string_view prev(keys[i - 1].ent->key, keys[i - 1].ent->keylen);
+    std::string_view cur(keys[i].ent->key, keys[i].ent->keylen);
+    if (prev.size() <= max_len && cur.size() <= max_len)
+      is_merged[i] = prev.ends_with(cur);
+    else
+      is_merged[i] = (prev == cur);
+  });
+
+  dynsym_owners.resize(syms.size());
+  for (i64 i = 0; i < syms.size(); i++)
+    dynsym_owners[i] = i;
+
+  for (i64 i = 1, owner = 0; i < keys.size(); i++) {
+    if (is_merged[i])
+      dynsym_owners[keys[i].ent - names.data()] = keys[owner].ent - names.data();
+    else
+      owner = i;
+  }
+
+  // Compute offsets of the names that are actually stored.
+  dynsym_offsets.resize(syms.size());
+
+  auto scan = [&](const tbb::blocked_range<i64> &r, i64 sum, bool is_final) {
+    for (i64 i = r.begin(); i < r.end(); i++) {
+      if (dynsym_owners[i] == i) {
+        if (is_final)
+          dynsym_offsets[i] = this->shdr.sh_size + sum;
+        sum += names[i].keylen + 1;
+      }
+    }
+    return sum;
+  };
+
+  i64 size = tbb::parallel_scan(
+    tbb::blocked_range<i64>(1, syms.size()), (i64)0, scan, std::plus());
+
+  // Other names refer to the tails of their owners.
+  static Counter counter("merged_dynstr_names");
+
+  tbb::parallel_for((i64)1, (i64)syms.size(), [&](i64 i) {
+    if (i64 j = dynsym_owners[i]; j != i) {
+      dynsym_offsets[i] = dynsym_offsets[j] + names[j].keylen - names[i].keylen;
+      counter++;
+    }
+  });
+
+  this->shdr.sh_size += size;
+}
+
 template <typename E>
 void DynstrSection<E>::copy_buf(Context<E> &ctx) {
   u8 *base = ctx.buf + this->shdr.sh_offset;
@@ -604,10 +797,12 @@ void DynstrSection<E>::copy_buf(Context<E> &ctx) {
   for (std::pair<std::string_view, i64> p : strings)
     write_string(base + p.second, p.first);
 
-  i64 off = ctx.dynsym->dynstr_offset;
-  for (Symbol<E> *sym : ctx.dynsym->symbols)
-    if (sym)
-      off += write_string(base + off, sym->name());
+  std::span<Symbol<E> *> syms = ctx.dynsym->symbols;
+
+  tbb::parallel_for((i64)1, (i64)syms.size(), [&](i64 i) {
+    if (dynsym_owners[i] == i)
+      write_string(base + dynsym_offsets[i], syms[i]->name());
+  });
 }
 
 template <typename E>
@@ -1477,48 +1672,68 @@ void OutputSection<E>::populate_symtab(Context<E> &ctx) {
   }
 }
 
+// Allocates GOT slots for symbols that need them. Slots are assigned in
+// the order of `syms`, and each symbol's slots are in the order of GOT,
+// GOTTP, TLSGD and TLSDESC. We compute slot indices as a prefix sum of
+// the number of slots each symbol needs so that they are assigned in
+// parallel but deterministically.
 template <typename E>
-void GotSection<E>::add_got_symbol(Context<E> &ctx, Symbol<E> *sym) {
-  sym->aux->got_idx = this->shdr.sh_size / sizeof(Word<E>);
+void GotSection<E>::add_symbols(Context<E> &ctx,
+                                const std::vector<Symbol<E> *> &syms) {
+  std::vector<Symbol<E> *> vec = parallel_filter(syms, [](Symbol<E> *sym) {
+    return sym->flags & (NEEDS_GOT | NEEDS_GOTTP | NEEDS_TLSGD | NEEDS_TLSDESC);
+  });
 
-  // An IFUNC symbol uses two GOT slots in a position-dependent
-  // executable.
-  if (sym->is_pde_ifunc(ctx))
-    this->shdr.sh_size += sizeof(Word<E>) * 2;
-  else
-    this->shdr.sh_size += sizeof(Word<E>);
+  i64 base = this->shdr.sh_size / sizeof(Word<E>);
 
-  got_syms.push_back(sym);
-}
+  auto scan = [&](const tbb::blocked_range<i64> &r, i64 sum, bool is_final) {
+    for (i64 i = r.begin(); i < r.end(); i++) {
+      Symbol<E> &sym = *vec[i];
 
-template <typename E>
-void GotSection<E>::add_gottp_symbol(Context<E> &ctx, Symbol<E> *sym) {
-  sym->aux->gottp_idx = this->shdr.sh_size / sizeof(Word<E>);
-  this->shdr.sh_size += sizeof(Word<E>);
-  gottp_syms.push_back(sym);
-}
+      auto alloc = [&](i32 &idx, i64 size) {
+        if (is_final)
+          idx = base + sum;
+        sum += size;
+      };
 
-template <typename E>
-void GotSection<E>::add_tlsgd_symbol(Context<E> &ctx, Symbol<E> *sym) {
-  sym->aux->tlsgd_idx = this->shdr.sh_size / sizeof(Word<E>);
-  this->shdr.sh_size += sizeof(Word<E>) * 2;
-  tlsgd_syms.push_back(sym);
-}
+      // An IFUNC symbol uses two GOT slots in a position-dependent
+      // executable.
+      if (sym.flags & NEEDS_GOT)
+        alloc(sym.aux->got_idx, sym.is_pde_ifunc(ctx) ? 2 : 1);
 
-template <typename E>
-void GotSection<E>::add_tlsdesc_symbol(Context<E> &ctx, Symbol<E> *sym) {
-  // TLSDESC's GOT slot values may vary depending on libc, so we
-  // always emit a dynamic relocation for each TLSDESC entry.
-  //
-  // If dynamic relocation is not available (i.e. if we are creating a
-  // statically-linked executable), we always relax TLSDESC relocations
-  // so that no TLSDESC relocation exist at runtime.
-  assert(supports_tlsdesc<E>);
-  assert(!ctx.arg.static_);
+      if (sym.flags & NEEDS_GOTTP)
+        alloc(sym.aux->gottp_idx, 1);
 
-  sym->aux->tlsdesc_idx = this->shdr.sh_size / sizeof(Word<E>);
-  this->shdr.sh_size += sizeof(Word<E>) * 2;
-  tlsdesc_syms.push_back(sym);
+      if (sym.flags & NEEDS_TLSGD)
+        alloc(sym.aux->tlsgd_idx, 2);
+
+      // TLSDESC's GOT slot values may vary depending on libc, so we
+      // always emit a dynamic relocation for each TLSDESC entry.
+      //
+      // If dynamic relocation is not available (i.e. if we are creating a
+      // statically-linked executable), we always relax TLSDESC relocations
+      // so that no TLSDESC relocation exist at runtime.
+      if (sym.flags & NEEDS_TLSDESC) {
+        assert(supports_tlsdesc<E>);
+        assert(!ctx.arg.static_);
+        alloc(sym.aux->tlsdesc_idx, 2);
+      }
+    }
+    return sum;
+  };
+
+  i64 num_slots = tbb::parallel_scan(
+    tbb::blocked_range<i64>(0, vec.size()), (i64)0, scan, std::plus());
+  this->shdr.sh_size += num_slots * sizeof(Word<E>);
+
+  auto filter = [&](u8 flag) {
+    return parallel_filter(vec, [&](Symbol<E> *sym) { return sym->flags & flag; });
+  };
+
+  append(got_syms, filter(NEEDS_GOT));
+  append(gottp_syms, filter(NEEDS_GOTTP));
+  append(tlsgd_syms, filter(NEEDS_TLSGD));
+  append(tlsdesc_syms, filter(NEEDS_TLSDESC));
 }
 
 template <typename E>
@@ -1879,12 +2094,18 @@ void GotPltSection<E>::copy_buf(Context<E> &ctx) {
   }
 }
 
+// A symbol in .plt must also be in .dynsym. The caller is responsible
+// for adding them to .dynsym.
 template <typename E>
-void PltSection<E>::add_symbol(Context<E> &ctx, Symbol<E> *sym) {
-  assert(!sym->has_plt(ctx));
-  sym->aux->plt_idx = symbols.size();
-  symbols.push_back(sym);
-  ctx.dynsym->add_symbol(ctx, sym);
+void PltSection<E>::add_symbols(Context<E> &ctx,
+                                const std::vector<Symbol<E> *> &syms) {
+  i64 base = symbols.size();
+  append(symbols, syms);
+
+  tbb::parallel_for((i64)0, (i64)syms.size(), [&](i64 i) {
+    assert(!syms[i]->has_plt(ctx));
+    syms[i]->aux->plt_idx = base + i;
+  });
 }
 
 template <typename E>
@@ -1958,12 +2179,17 @@ void PltSection<E>::populate_symtab(Context<E> &ctx) {
 }
 
 template <typename E>
-void PltGotSection<E>::add_symbol(Context<E> &ctx, Symbol<E> *sym) {
-  assert(!sym->has_plt(ctx));
-  assert(sym->has_got(ctx));
+void PltGotSection<E>::add_symbols(Context<E> &ctx,
+                                   const std::vector<Symbol<E> *> &syms) {
+  i64 base = symbols.size();
+  append(symbols, syms);
+
+  tbb::parallel_for((i64)0, (i64)syms.size(), [&](i64 i) {
+    assert(!syms[i]->has_plt(ctx));
+    assert(syms[i]->has_got(ctx));
+    syms[i]->aux->pltgot_idx = base + i;
+  });
 
-  sym->aux->pltgot_idx = symbols.size();
-  symbols.push_back(sym);
   this->shdr.sh_size = symbols.size() * E::pltgot_size;
 }
 
@@ -2207,6 +2433,23 @@ void DynsymSection<E>::add_symbol(Context<E> &ctx, Symbol<E> *sym) {
   }
 }
 
+// Same as add_symbol, but for symbols that are known not to be in
+// .dynsym yet.
+template <typename E>
+void DynsymSection<E>::add_symbols(Context<E> &ctx,
+                                   const std::vector<Symbol<E> *> &syms) {
+  if (syms.empty())
+    return;
+  if (symbols.empty())
+    symbols.resize(1);
+
+  tbb::parallel_for_each(syms, [&](Symbol<E> *sym) {
+    assert(sym->get_dynsym_idx(ctx) == -1);
+    sym->aux->dynsym_idx = -2;
+  });
+  append(symbols, syms);
+}
+
 template <typename E>
 void DynsymSection<E>::update_shdr(Context<E> &ctx) {
   this->shdr.sh_link = ctx.dynstr->shndx;
@@ -2216,25 +2459,25 @@ void DynsymSection<E>::update_shdr(Context<E> &ctx) {
 template <typename E>
 void DynsymSection<E>::copy_buf(Context<E> &ctx) {
   ElfSym<E> *buf = (ElfSym<E> *)(ctx.buf + this->shdr.sh_offset);
-  i64 offset = dynstr_offset;
+  std::atomic_bool has_error = false;
 
   memset(buf, 0, sizeof(ElfSym<E>));
 
-  for (i64 i = 1; i < symbols.size(); i++) {
+  tbb::parallel_for((i64)1, (i64)symbols.size(), [&](i64 i) {
     Symbol<E> &sym = *symbols[i];
+    u32 st_name = ctx.dynstr->dynsym_offsets[i];
 
-    std::optional<ElfSym<E>> esym = to_output_esym(ctx, sym, offset, nullptr);
-    if (!esym) {
-      Error(ctx) << ctx.arg.output
-                 << ": .dynsym: too many output sections: "
-                 << (ctx.shdr->shdr.sh_size / sizeof(ElfShdr<E>))
-                 << " requested, but ELF allows at most 65279";
-      return;
-    }
+    if (std::optional<ElfSym<E>> esym = to_output_esym(ctx, sym, st_name, nullptr))
+      buf[sym.get_dynsym_idx(ctx)] = *esym;
+    else
+      has_error = true;
+  });
 
-    buf[sym.get_dynsym_idx(ctx)] = *esym;
-    offset += sym.name().size() + 1;
-  }
+  if (has_error)
+    Error(ctx) << ctx.arg.output
+               << ": .dynsym: too many output sections: "
+               << (ctx.shdr->shdr.sh_size / sizeof(ElfShdr<E>))
+               << " requested, but ELF allows at most 65279";
 }
 
 template <typename E>
@@ -2261,12 +2504,39 @@ void HashSection<E>::copy_buf(Context<E> &ctx) {
   hdr[0] = syms.size();
   hdr[1] = syms.size();
 
-  for (Symbol<E> *sym : syms.subspan(1)) {
-    i64 i = sym->get_dynsym_idx(ctx);
-    i64 h = elf_hash(sym->name()) % syms.size();
-    chains[i] = buckets[h];
-    buckets[h] = i;
-  }
+  // Hashing symbol names is the most expensive part, so do it first in
+  // parallel.
+  std::vector<u32> hashes(syms.size());
+  tbb::parallel_for((i64)1, (i64)syms.size(), [&](i64 i) {
+    hashes[i] = elf_hash(syms[i]->name()) % syms.size();
+  });
+
+  // Each chain links symbols in a bucket in descending index order. To
+  // build chains in parallel, we split buckets into shards. We first
+  // group symbols by shard with a counting sort, which keeps them in
+  // index order within each shard, and then link each shard's symbols
+  // in parallel. The result is the same as the serial construction.
+  constexpr i64 NUM_SHARDS = 16;
+  i64 shard_size = align_to(syms.size(), NUM_SHARDS) / NUM_SHARDS;
+
+  std::vector<u32> begin(NUM_SHARDS + 1);
+  for (i64 i = 1; i < syms.size(); i++)
+    begin[hashes[i] / shard_size + 1]++;
+  for (i64 i = 1; i <= NUM_SHARDS; i++)
+    begin[i] += begin[i - 1];
+
+  std::vector<u32> indices(syms.size());
+  std::vector<u32> pos(begin.begin(), begin.end() - 1);
+  for (i64 i = 1; i < syms.size(); i++)
+    indices[pos[hashes[i] / shard_size]++] = i;
+
+  tbb::parallel_for((i64)0, NUM_SHARDS, [&](i64 shard) {
+    for (i64 j = begin[shard]; j < begin[shard + 1]; j++) {
+      u32 i = indices[j];
+      chains[i] = buckets[hashes[i]];
+      buckets[hashes[i]] = i;
+    }
+  });
 }
 
 template <typename E>
@@ -2274,8 +2544,9 @@ void GnuHashSection<E>::update_shdr(Context<E> &ctx) {
   if (ctx.dynsym->symbols.empty())
     return;
 
-  // We allocate 12 bits for each symbol in the bloom filter.
-  num_bloom = bit_ceil((num_exported * 12) / (sizeof(Word<E>) * 8));
+  // We allocate 12 bits for each symbol in the bloom filter by default.
+  num_bloom = bit_ceil((num_exported * ctx.arg.hash_bloom_bits) /
+                       (sizeof(Word<E>) * 8));
 
   this->shdr.sh_size = HEADER_SIZE;                  // Header
   this->shdr.sh_size += num_bloom * sizeof(Word<E>); // Bloom filter
@@ -2303,31 +2574,37 @@ void GnuHashSection<E>::copy_buf(Context<E> &ctx) {
   if (syms.empty())
     return;
 
-  // Write a bloom filter
-  Word<E> *bloom = (Word<E> *)(base + HEADER_SIZE);
+  // Compute a bloom filter. Since multiple symbols may set bits in the
+  // same word, we build it in native-endian words with atomic ORs first.
+  constexpr i64 word_bits = sizeof(Word<E>) * 8;
+  std::vector<u64> words(num_bloom);
   std::vector<u32> indices(num_exported);
 
-  for (i64 i = 0; i < syms.size(); i++) {
-    constexpr i64 word_bits = sizeof(Word<E>) * 8;
-
+  tbb::parallel_for((i64)0, (i64)syms.size(), [&](i64 i) {
     u32 h = syms[i]->aux->djb_hash;
     indices[i] = h % num_buckets;
 
     i64 idx = (h / word_bits) % num_bloom;
-    bloom[idx] |= 1LL << (h % word_bits);
-    bloom[idx] |= 1LL << ((h >> BLOOM_SHIFT) % word_bits);
-  }
-
-  // Write hash bucket indices
-  U32<E> *buckets = (U32<E> *)(bloom + num_bloom);
+    u64 mask = (1LL << (h % word_bits)) |
+               (1LL << ((h >> BLOOM_SHIFT) % word_bits));
+    std::atomic_ref(words[idx]).fetch_or(mask, std::memory_order_relaxed);
+  });
 
-  for (i64 i = syms.size() - 1; i >= 0; i--)
-    buckets[indices[i]] = first_exported + i;
+  Word<E> *bloom = (Word<E> *)(base + HEADER_SIZE);
+  tbb::parallel_for((i64)0, num_bloom, [&](i64 i) {
+    bloom[i] = words[i];
+  });
 
-  // Write a hash table
+  // Write hash bucket indices and a hash table. Symbols have been sorted
+  // by bucket index by sort_dynsyms(), so each bucket points to the first
+  // symbol of a run of the same bucket index.
+  U32<E> *buckets = (U32<E> *)(bloom + num_bloom);
   U32<E> *table = buckets + num_buckets;
 
-  for (i64 i = 0; i < syms.size(); i++) {
+  tbb::parallel_for((i64)0, (i64)syms.size(), [&](i64 i) {
+    if (i == 0 || indices[i - 1] != indices[i])
+      buckets[indices[i]] = first_exported + i;
+
     // The last entry in a chain must be terminated with an entry with
     // least-significant bit 1.
     u32 h = syms[i]->aux->djb_hash;
@@ -2335,7 +2612,7 @@ void GnuHashSection<E>::copy_buf(Context<E> &ctx) {
       table[i] = h | 1;
     else
       table[i] = h & ~1;
-  }
+  });
 }
 
 template <typename E>
@@ -2491,15 +2768,82 @@ void MergedSection<E>::resolve(Context<E> &ctx) {
   resolved = true;
 }
 
+// If a string is a suffix of another string, e.g. "bar" and "foobar",
+// the former doesn't have to be stored separately; it can point to the
+// tail of the latter. This is known as tail merging.
+//
+// If we sort strings by their reversed contents in descending order,
+// every string that ends with a given string S comes right before S.
+// So, S is a suffix of some string if and only if it is a suffix of
+// its immediate predecessor, and we only have to compare neighbors.
+template <typename E>
+void MergedSection<E>::tail_merge_strings(Context<E> &ctx) {
+  for (auto [ent, _] : tail_merged)
+    ent->value.is_tail_merged = false;
+  tail_merged.clear();
+
+  // A tail-merged string may start at any character boundary, so we
+  // exclude overaligned strings. Strings that have to be in the first
+  // 4 GiB are placed separately from the others, so we exclude them
+  // too. Strings longer than --tail-merge-strings bytes, not counting
+  // the terminator, are excluded to bound the cost of sorting.
+  i64 entsize = this->shdr.sh_entsize;
+  i64 shard_size = map.nbuckets / map.NUM_SHARDS;
+  std::vector<std::vector<Entry *>> vecs(map.NUM_SHARDS);
+
+  tbb::parallel_for((i64)0, map.NUM_SHARDS, [&](i64 i) {
+    for (i64 j = shard_size * i; j < shard_size * (i + 1); j++) {
+      Entry &ent = map.entries[j];
+      SectionFragment<E> &frag = ent.value;
+      if (ent.key && frag.is_alive && !frag.is_32bit &&
+          (1 << frag.p2align) <= entsize &&
+          ent.keylen - entsize <= ctx.arg.tail_merge_strings)
+        vecs[i].push_back(&ent);
+    }
+  });
+
+  std::vector<Entry *> vec = flatten(vecs);
+
+  {
+    std::vector<ReversedStringSortKey<Entry>> keys(vec.begin(), vec.end());
+    sort_by_reversed_contents<Entry>(keys, 0);
+    for (i64 i = 0; i < vec.size(); i++)
+      vec[i] = keys[i].ent;
+  }
+
+  std::vector<u8> is_suffix(vec.size());
+
+  tbb::parallel_for((i64)1, (i64)vec.size(), [&](i64 i) {
+    std::string_view prev(vec[i - 1]->key, vec[i - 1]->keylen);
+    std::string_view cur(vec[i]->key, vec[i]->keylen);
+    is_suffix[i] = prev.ends_with(cur);
+  });
+
+  Entry *container = nullptr;
+  for (i64 i = 0; i < vec.size(); i++) {
+    if (is_suffix[i]) {
+      vec[i]->value.is_tail_merged = true;
+      tail_merged.push_back({vec[i], container});
+    } else {
+      container = vec[i];
+    }
+  }
+
+  static Counter counter("tail_merged_strings");
+  counter += tail_merged.size();
+}
+
 template <typename E>
 void MergedSection<E>::compute_section_size(Context<E> &ctx) {
   if (!resolved)
     resolve(ctx);
 
+  if (ctx.arg.tail_merge_strings && (this->shdr.sh_flags & SHF_STRINGS))
+    tail_merge_strings(ctx);
+
   std::vector<i64> sizes(map.NUM_SHARDS * 2);
 
   tbb::parallel_for((i64)0, map.NUM_SHARDS, [&](i64 i) {
-    using Entry = typename decltype(map)::Entry;
     std::vector<Entry *> entries = map.get_sorted_entries(i);
 
     i64 off1 = 0;
@@ -2507,7 +2851,7 @@ void MergedSection<E>::compute_section_size(Context<E> &ctx) {
 
     for (Entry *ent : entries) {
       SectionFragment<E> &frag = ent->value;
-      if (frag.is_alive) {
+      if (frag.is_alive && !frag.is_tail_merged) {
         if (frag.is_32bit) {
           off1 = align_to(off1, 1 << frag.p2align);
           frag.offset = off1;
@@ -2536,7 +2880,7 @@ void MergedSection<E>::compute_section_size(Context<E> &ctx) {
   tbb::parallel_for((i64)1, map.NUM_SHARDS, [&](i64 i) {
     for (i64 j = shard_size * i; j < shard_size * (i + 1); j++) {
       SectionFragment<E> &frag = map.entries[j].value;
-      if (frag.is_alive) {
+      if (frag.is_alive && !frag.is_tail_merged) {
         if (frag.is_32bit)
           frag.offset += shard_offsets[i];
         else
@@ -2544,6 +2888,12 @@ void MergedSection<E>::compute_section_size(Context<E> &ctx) {
       }
     }
   });
+
+  tbb::parallel_for_each(tail_merged, [](std::pair<Entry *, Entry *> p) {
+    auto [ent, container] = p;
+    ent->value.offset =
+      container->value.offset + container->keylen - ent->keylen;
+  });
 }
 
 template <typename E>
@@ -2568,7 +2918,8 @@ void MergedSection<E>::write_to(Context<E> &ctx, u8 *buf) {
     // Copy strings
     for (i64 j = shard_size * i; j < shard_size * (i + 1); j++)
       if (const char *key = map.entries[j].key)
-        if (SectionFragment<E> &frag = map.entries[j].value; frag.is_alive)
+        if (SectionFragment<E> &frag = map.entries[j].value;
+            frag.is_alive && !frag.is_tail_merged)
           memcpy(buf + frag.offset, key, map.entries[j].keylen);
   });
 }
@@ -2595,9 +2946,17 @@ void EhFrameSection<E>::construct(Context<E> &ctx) {
     std::erase_if(file->fdes, [](FdeRecord<E> &fde) { return !fde.is_alive; });
 
     i64 offset = 0;
-    for (FdeRecord<E> &fde : file->fdes) {
+    for (i64 i = 0; i < file->fdes.size(); i++) {
+      FdeRecord<E> &fde = file->fdes[i];
       fde.output_offset = offset;
       offset += fde.size(*file);
+
+      // Removing dead FDEs shifted live ones, so update the indices that
+      // input sections use to find their FDEs.
+      if (i == 0 || file->fdes[i - 1].is_last) {
+        const ElfRel<E> &rel = fde.get_rels(*file)[0];
+        file->get_section(file->elf_syms[rel.r_sym])->fde_begin = i;
+      }
     }
     file->fde_size = offset;
   });
@@ -2626,11 +2985,7 @@ void EhFrameSection<E>::construct(Context<E> &ctx) {
   }
 
   // Assign FDE offsets to files.
-  i64 idx = 0;
   for (ObjectFile<E> *file : ctx.objs) {
-    file->fde_idx = idx;
-    idx += file->fdes.size();
-
     file->fde_offset = offset;
     offset += file->fde_size;
   }
@@ -2639,21 +2994,10 @@ void EhFrameSection<E>::construct(Context<E> &ctx) {
   this->shdr.sh_size = offset + 4;
 }
 
-// Write to .eh_frame and .eh_frame_hdr.
 template <typename E>
 void EhFrameSection<E>::copy_buf(Context<E> &ctx) {
   u8 *base = ctx.buf + this->shdr.sh_offset;
 
-  struct HdrEntry {
-    I32<E> init_addr;
-    I32<E> fde_addr;
-  };
-
-  HdrEntry *eh_hdr = nullptr;
-  if (ctx.eh_frame_hdr)
-    eh_hdr = (HdrEntry *)(ctx.buf + ctx.eh_frame_hdr->shdr.sh_offset +
-                          EhFrameHdrSection<E>::HEADER_SIZE);
-
   tbb::parallel_for_each(ctx.objs, [&](ObjectFile<E> *file) {
     // Copy CIEs.
     for (CieRecord<E> &cie : file->cies) {
@@ -2691,57 +3035,19 @@ void EhFrameSection<E>::copy_buf(Context<E> &ctx) {
       if (ctx.arg.relocatable)
         continue;
 
-      // Always set in the loop below because parse_ehframe() discards
-      // FDEs that have no relocations.
-      u64 func_addr = -1;
-
-      for (i64 j = 0; j < rels.size(); j++) {
-        const ElfRel<E> &rel = rels[j];
+      for (const ElfRel<E> &rel : rels) {
         assert(rel.r_offset - fde.input_offset < contents.size());
 
         Symbol<E> &sym = *file->symbols[rel.r_sym];
         u64 loc = offset + rel.r_offset - fde.input_offset;
         u64 val = sym.get_addr(ctx) + get_addend(cie.input_section, rel);
         apply_eh_reloc(ctx, rel, loc, val);
-
-        if (j == 0)
-          func_addr = val;
-      }
-
-      if (!eh_hdr)
-        continue;
-
-      // Write to .eh_frame_hdr
-      HdrEntry &ent = eh_hdr[file->fde_idx + i];
-      u8 *ptr = base + offset + 8 + cie.fde_ptr_size;
-      u64 range = (cie.fde_ptr_size == 4) ? *(U32<E> *)ptr : *(U64<E> *)ptr;
-
-      if (range == 0) {
-        // Compilers may emit a meaningless FDE covering a zero-length
-        // address range. Such an FDE must not be written to .eh_frame_hdr
-        // because another function may start at the same address, and a
-        // binary search on .eh_frame_hdr could then find the empty FDE
-        // instead of the real one. We write a tombstone value instead.
-        ent.init_addr = INT32_MAX;
-        ent.fde_addr = 0;
-      } else {
-        u64 origin = ctx.eh_frame_hdr->shdr.sh_addr;
-        ent.init_addr = func_addr - origin;
-        ent.fde_addr = this->shdr.sh_addr + offset - origin;
       }
     }
   });
 
   // Write a terminator.
   *(U32<E> *)(base + this->shdr.sh_size - 4) = 0;
-
-  // Sort .eh_frame_hdr contents.
-  if (eh_hdr) {
-    tbb::parallel_sort(eh_hdr, eh_hdr + ctx.eh_frame_hdr->num_fdes,
-                      [](const HdrEntry &a, const HdrEntry &b) {
-      return a.init_addr < b.init_addr;
-    });
-  }
 }
 
 // Lay out the output .sframe section. Like .eh_frame, .sframe is parsed
@@ -2894,6 +3200,112 @@ void EhFrameHdrSection<E>::copy_buf(Context<E> &ctx) {
 
   *(U32<E> *)(base + 4) = ctx.eh_frame->shdr.sh_addr - this->shdr.sh_addr - 4;
   *(U32<E> *)(base + 8) = num_fdes;
+
+  write_table(ctx, base + HEADER_SIZE);
+}
+
+// Write the binary search table of .eh_frame_hdr. The table has to be
+// sorted by function address, but FDEs are usually already in that
+// order if we visit them in the order of the functions they describe.
+// So we write entries in the output section member order and then sort
+// only a subrange that is out of order, if any. This is much faster than
+// sorting the entire table for programs with millions of FDEs.
+template <typename E>
+void EhFrameHdrSection<E>::write_table(Context<E> &ctx, u8 *buf) {
+  struct HdrEntry {
+    I32<E> init_addr;
+    I32<E> fde_addr;
+  };
+
+  HdrEntry *table = (HdrEntry *)buf;
+
+  // Collect input sections that have FDEs in the output address order.
+  std::vector<InputSection<E> *> sections;
+  for (Chunk<E> *chunk : ctx.chunks)
+    if (OutputSection<E> *osec = chunk->to_osec())
+      for (InputSection<E> *isec : osec->members)
+        if (isec->fde_begin != -1)
+          sections.push_back(isec);
+
+  // Compute the position of the first table entry for each section.
+  // Compilers may emit a meaningless FDE covering a zero-length address
+  // range. Such an FDE must not be written to .eh_frame_hdr because
+  // another function may start at the same address, and a binary search
+  // on .eh_frame_hdr could then find the empty FDE instead of the real
+  // one. We write tombstones for them at the end of the table instead.
+  auto get_range = [](ObjectFile<E> &file, FdeRecord<E> &fde) -> u64 {
+    CieRecord<E> &cie = file.cies[fde.cie_idx];
+    u8 *ptr = (u8 *)fde.get_contents(file).data() + 8 + cie.fde_ptr_size;
+    return (cie.fde_ptr_size == 4) ? *(U32<E> *)ptr : *(U64<E> *)ptr;
+  };
+
+  std::vector<i64> offsets(sections.size() + 1);
+
+  tbb::parallel_for((i64)0, (i64)sections.size(), [&](i64 i) {
+    InputSection<E> &isec = *sections[i];
+    for (FdeRecord<E> &fde : isec.get_fdes())
+      if (get_range(*isec.file, fde))
+        offsets[i + 1]++;
+  });
+
+  for (i64 i = 1; i < offsets.size(); i++)
+    offsets[i] += offsets[i - 1];
+
+  i64 num_entries = offsets.back();
+  assert(num_entries <= num_fdes);
+
+  // Write table entries.
+  u64 origin = this->shdr.sh_addr;
+
+  tbb::parallel_for((i64)0, (i64)sections.size(), [&](i64 i) {
+    InputSection<E> &isec = *sections[i];
+    ObjectFile<E> &file = *isec.file;
+    HdrEntry *ent = table + offsets[i];
+
+    for (FdeRecord<E> &fde : isec.get_fdes()) {
+      if (!get_range(file, fde))
+        continue;
+
+      CieRecord<E> &cie = file.cies[fde.cie_idx];
+      const ElfRel<E> &rel = fde.get_rels(file)[0];
+      Symbol<E> &sym = *file.symbols[rel.r_sym];
+      u64 func_addr = sym.get_addr(ctx) + get_addend(cie.input_section, rel);
+      u64 fde_addr = ctx.eh_frame->shdr.sh_addr + file.fde_offset +
+                     fde.output_offset;
+
+      ent->init_addr = func_addr - origin;
+      ent->fde_addr = fde_addr - origin;
+      ent++;
+    }
+  });
+
+  for (i64 i = num_entries; i < num_fdes; i++) {
+    table[i].init_addr = INT32_MAX;
+    table[i].fde_addr = 0;
+  }
+
+  // Find the smallest subrange that needs sorting.
+  auto less = [](const HdrEntry &a, const HdrEntry &b) {
+    return a.init_addr < b.init_addr;
+  };
+
+  i64 first = num_entries;
+  i64 last = 0;
+
+  for (i64 i = 1; i < num_entries; i++) {
+    if (less(table[i], table[i - 1])) {
+      first = std::min(first, i - 1);
+      last = i + 1;
+    }
+  }
+
+  if (first < last) {
+    HdrEntry min = *std::min_element(table + first, table + last, less);
+    HdrEntry max = *std::max_element(table + first, table + last, less);
+    HdrEntry *begin = std::upper_bound(table, table + first, min, less);
+    HdrEntry *end = std::lower_bound(table + last, table + num_entries, max, less);
+    tbb::parallel_sort(begin, end, less);
+  }
 }
 
 template <typename E>
@@ -3071,28 +3483,40 @@ void VerneedSection<E>::construct(Context<E> &ctx) {
   Timer t(ctx, "fill_verneed");
 
   // Create a list of versioned symbols and sort by file and version.
-  std::vector<Symbol<E> *> syms;
-
-  for (i64 i = 1; i < ctx.dynsym->symbols.size(); i++) {
-    Symbol<E> &sym = *ctx.dynsym->symbols[i];
-    if (sym.file->is_dso && VER_NDX_LAST_RESERVED < sym.ver_idx)
-      syms.push_back(&sym);
-  }
+  std::vector<Symbol<E> *> syms =
+    parallel_filter(ctx.dynsym->symbols, [](Symbol<E> *sym) {
+      return sym && sym->file->is_dso && VER_NDX_LAST_RESERVED < sym->ver_idx;
+    });
 
   if (syms.empty())
     return;
 
-  ranges::stable_sort(syms, {}, [](Symbol<E> *x) {
-    return std::tuple{x->file->to_dso()->soname, x->ver_idx};
+  tbb::parallel_sort(syms, [&](Symbol<E> *a, Symbol<E> *b) {
+    return std::tuple(a->file->to_dso()->soname, a->ver_idx,
+                      a->get_dynsym_idx(ctx)) <
+           std::tuple(b->file->to_dso()->soname, b->ver_idx,
+                      b->get_dynsym_idx(ctx));
   });
 
+  // Find the first symbol of each file and version pair.
+  std::vector<i64> starts(syms.size());
+  for (i64 i = 0; i < syms.size(); i++)
+    starts[i] = i;
+
+  starts = parallel_filter(starts, [&](i64 i) {
+    return i == 0 || syms[i - 1]->file != syms[i]->file ||
+           syms[i - 1]->ver_idx != syms[i]->ver_idx;
+  });
+  starts.push_back(syms.size());
+
   // Resize .gnu.version
   ctx.versym->contents.resize(ctx.dynsym->symbols.size(), VER_NDX_GLOBAL);
   ctx.versym->contents[0] = VER_NDX_LOCAL;
 
-  // Allocate a large enough buffer for .gnu.version_r.
-  contents.resize((sizeof(ElfVerneed<E>) + sizeof(ElfVernaux<E>)) *
-                  (syms.size() + 1));
+  // Allocate a large enough buffer for .gnu.version_r. Each file may
+  // have an extra GLIBC_ABI_DT_RELR entry.
+  contents.resize((sizeof(ElfVerneed<E>) + sizeof(ElfVernaux<E>) * 2) *
+                  starts.size());
 
   // Fill .gnu.version_r.
   u8 *buf = (u8 *)&contents[0];
@@ -3132,16 +3556,22 @@ void VerneedSection<E>::construct(Context<E> &ctx) {
   };
 
   // Create version entries.
-  for (i64 i = 0; i < syms.size(); i++) {
-    if (i == 0 || syms[i - 1]->file != syms[i]->file) {
-      start_group(*syms[i]->file->to_dso());
-      add_entry(syms[i]->get_version());
-    } else if (syms[i - 1]->ver_idx != syms[i]->ver_idx) {
-      add_entry(syms[i]->get_version());
-    }
-    ctx.versym->contents[syms[i]->get_dynsym_idx(ctx)] = veridx;
+  std::vector<i64> veridxs(starts.size() - 1);
+
+  for (i64 i = 0; i < starts.size() - 1; i++) {
+    Symbol<E> &sym = *syms[starts[i]];
+    if (i == 0 || syms[starts[i - 1]]->file != sym.file)
+      start_group(*sym.file->to_dso());
+    add_entry(sym.get_version());
+    veridxs[i] = veridx;
   }
 
+  // Write version indices to .gnu.version.
+  tbb::parallel_for((i64)0, (i64)starts.size() - 1, [&](i64 i) {
+    for (i64 j = starts[i]; j < starts[i + 1]; j++)
+      ctx.versym->contents[syms[j]->get_dynsym_idx(ctx)] = veridxs[i];
+  });
+
   // Resize .gnu.version_r to fit to its contents.
   contents.resize(ptr - buf);
 }
@@ -3164,28 +3594,29 @@ void VerdefSection<E>::construct(Context<E> &ctx) {
   if (ctx.arg.version_definitions.empty())
     return;
 
-  // Handle --default-symver
-  if (ctx.arg.default_symver)
-    for (Symbol<E> *sym : ctx.dynsym->symbols)
-      if (sym && !sym->file->is_dso && !sym->esym().is_undef())
-        if (u16 ver = sym->ver_idx;
-            ver == VER_NDX_GLOBAL || ver == VER_NDX_UNSPECIFIED)
-          sym->ver_idx = VER_NDX_LAST_RESERVED + 1;
+  std::span<Symbol<E> *> syms = ctx.dynsym->symbols;
 
   // Resize .gnu.version and write to it
-  ctx.versym->contents.resize(ctx.dynsym->symbols.size(), VER_NDX_GLOBAL);
+  ctx.versym->contents.resize(syms.size(), VER_NDX_GLOBAL);
   ctx.versym->contents[0] = VER_NDX_LOCAL;
 
-  for (Symbol<E> *sym : ctx.dynsym->symbols) {
-    if (!sym || sym->file->is_dso)
-      continue;
+  tbb::parallel_for((i64)1, (i64)syms.size(), [&](i64 i) {
+    Symbol<E> &sym = *syms[i];
+    if (sym.file->is_dso)
+      return;
+
+    // Handle --default-symver
+    if (ctx.arg.default_symver && !sym.esym().is_undef())
+      if (u16 ver = sym.ver_idx;
+          ver == VER_NDX_GLOBAL || ver == VER_NDX_UNSPECIFIED)
+        sym.ver_idx = VER_NDX_LAST_RESERVED + 1;
 
     // An unversioned undefined symbol takes version index 0.
-    if (sym->ver_idx != VER_NDX_UNSPECIFIED)
-      ctx.versym->contents[sym->get_dynsym_idx(ctx)] = sym->ver_idx;
-    else if (sym->esym().is_undef())
-      ctx.versym->contents[sym->get_dynsym_idx(ctx)] = VER_NDX_LOCAL;
-  }
+    if (sym.ver_idx != VER_NDX_UNSPECIFIED)
+      ctx.versym->contents[sym.get_dynsym_idx(ctx)] = sym.ver_idx;
+    else if (sym.esym().is_undef())
+      ctx.versym->contents[sym.get_dynsym_idx(ctx)] = VER_NDX_LOCAL;
+  });
 
   // Allocate a buffer for .gnu.version_d and write to it
   contents.resize((sizeof(ElfVerdef<E>) + sizeof(ElfVerdaux<E>)) *
@@ -3398,17 +3829,24 @@ void CompressedSection<E>::copy_buf(Context<E> &ctx) {
 template <typename E>
 RelocSection<E>::RelocSection(Context<E> &ctx, OutputSection<E> &osec)
   : output_section(osec) {
-  if constexpr (E::is_rela) {
-    this->name = save_string(ctx, ".rela" + std::string(osec.name));
-    this->shdr.sh_type = SHT_RELA;
+  if (ctx.arg.z_crel) {
+    this->name = save_string(ctx, ".crel" + std::string(osec.name));
+    this->shdr.sh_type = SHT_CREL;
+    this->shdr.sh_addralign = 1;
+    this->shdr.sh_entsize = 1;
   } else {
-    this->name = save_string(ctx, ".rel" + std::string(osec.name));
-    this->shdr.sh_type = SHT_REL;
+    if constexpr (E::is_rela) {
+      this->name = save_string(ctx, ".rela" + std::string(osec.name));
+      this->shdr.sh_type = SHT_RELA;
+    } else {
+      this->name = save_string(ctx, ".rel" + std::string(osec.name));
+      this->shdr.sh_type = SHT_REL;
+    }
+    this->shdr.sh_addralign = sizeof(Word<E>);
+    this->shdr.sh_entsize = sizeof(ElfRel<E>);
   }
 
   this->shdr.sh_flags = SHF_INFO_LINK;
-  this->shdr.sh_addralign = sizeof(Word<E>);
-  this->shdr.sh_entsize = sizeof(ElfRel<E>);
 
   // Compute an offset for each input section
   offsets.resize(osec.members.size());
@@ -3426,7 +3864,13 @@ RelocSection<E>::RelocSection(Context<E> &ctx, OutputSection<E> &osec)
   i64 num_entries = tbb::parallel_scan(
     tbb::blocked_range<i64>(0, osec.members.size()), 0, scan, std::plus());
 
-  this->shdr.sh_size = num_entries * sizeof(ElfRel<E>);
+  // The size of a CREL section isn't known until compute_crel_size() is
+  // called. Until then, we use the number of relocations as a placeholder
+  // so that a section without relocations is removed as an empty one.
+  if (ctx.arg.z_crel)
+    this->shdr.sh_size = num_entries;
+  else
+    this->shdr.sh_size = num_entries * sizeof(ElfRel<E>);
 }
 
 template <typename E>
@@ -3471,8 +3915,25 @@ get_symidx_addend(Context<E> &ctx, InputSection<E> &isec, const ElfRel<E> &rel)
   return {0, 0};
 }
 
+// Returns the output r_offset of a given input relocation.
+template <typename E>
+static u64 get_output_offset(InputSection<E> &isec, const ElfRel<E> &rel) {
+  u64 r_offset = isec.output_section->shdr.sh_addr + isec.offset + rel.r_offset;
+
+  // On RISC-V and LoongArch, relaxation may have deleted instructions,
+  // shifting this relocation's offset.
+  if constexpr (is_riscv<E> || is_loongarch<E>)
+    r_offset -= get_r_delta(isec, rel.r_offset);
+  return r_offset;
+}
+
 template <typename E>
 void RelocSection<E>::copy_buf(Context<E> &ctx) {
+  if (ctx.arg.z_crel) {
+    copy_crel(ctx);
+    return;
+  }
+
   tbb::parallel_for((i64)0, (i64)output_section.members.size(), [&](i64 i) {
     ElfRel<E> *buf = (ElfRel<E> *)(ctx.buf + this->shdr.sh_offset) + offsets[i];
     InputSection<E> &isec = *output_section.members[i];
@@ -3483,18 +3944,11 @@ void RelocSection<E>::copy_buf(Context<E> &ctx) {
       i64 addend;
       std::tie(symidx, addend) = get_symidx_addend(ctx, isec, rel);
 
-      i64 r_offset = isec.output_section->shdr.sh_addr + isec.offset + rel.r_offset;
-
-      // On RISC-V and LoongArch, relaxation may have deleted instructions,
-      // shifting this relocation's offset.
-      if constexpr (is_riscv<E> || is_loongarch<E>)
-        r_offset -= get_r_delta(isec, rel.r_offset);
-
       // SH4 object files store addends in the relocated places rather
       // than in r_addend, and the relocation records we emit here are
       // meant to be consumed as if they were in an object file, so we
       // follow that convention.
-      buf[j++] = ElfRel<E>(r_offset, rel.r_type, symidx,
+      buf[j++] = ElfRel<E>(get_output_offset(isec, rel), rel.r_type, symidx,
                            is_sh4<E> ? 0 : addend);
 
       if (ctx.arg.relocatable) {
@@ -3505,6 +3959,207 @@ void RelocSection<E>::copy_buf(Context<E> &ctx) {
   });
 }
 
+// CREL is a compact relocation format. Each record consists of a flag
+// byte followed by deltas from the previous record; fields that are the
+// same as in the previous record are omitted. The flag byte also holds
+// the low bits of the offset delta, so a typical record is only 2 or 3
+// bytes long, compared to 24 bytes for a RELA record on 64-bit targets.
+//
+// A record depends only on itself and its immediate predecessor, so we
+// encode the relocations of input sections in parallel, starting each
+// input section with the last record of the preceding ones.
+struct CrelRecord {
+  u64 offset = 0;
+  i64 symidx = 0;
+  i64 type = 0;
+  i64 addend = 0;
+};
+
+template <typename E>
+static CrelRecord
+get_crel_record(Context<E> &ctx, InputSection<E> &isec, const ElfRel<E> &rel) {
+  auto [symidx, addend] = get_symidx_addend(ctx, isec, rel);
+  return {get_output_offset(isec, rel), symidx, rel.r_type, addend};
+}
+
+// SH4 stores addends in the relocated places as explained above.
+template <typename E>
+static constexpr bool crel_has_addend = E::is_rela && !is_sh4<E>;
+
+// Encodes the relocations of a given input section and returns the number
+// of bytes. If buf is null, only the size is computed.
+//
+// If pad_type is true, type deltas are always written as two-byte SLEB128
+// values. We use it for --emit-relocs because relaxation may rewrite
+// relocation types while we are copying section contents, which is after
+// the file layout is fixed.
+template <typename E>
+static i64 encode_crel(Context<E> &ctx, InputSection<E> &isec, CrelRecord prev,
+                       i64 shift, bool pad_type, u8 *buf) {
+  constexpr i64 nflags = crel_has_addend<E> ? 3 : 2;
+  i64 size = 0;
+
+  auto put = [&](u8 byte) {
+    if (buf)
+      buf[size] = byte;
+    size++;
+  };
+
+  auto put_uleb = [&](u64 val) {
+    do {
+      u8 byte = val & 0x7f;
+      val >>= 7;
+      put(val ? (byte | 0x80) : byte);
+    } while (val);
+  };
+
+  auto put_sleb = [&](i64 val) {
+    for (;;) {
+      u8 byte = val & 0x7f;
+      val >>= 7;
+
+      bool neg = (byte & 0x40);
+      if ((val == 0 && !neg) || (val == -1 && neg)) {
+        put(byte);
+        return;
+      }
+      put(byte | 0x80);
+    }
+  };
+
+  for (const ElfRel<E> &rel : isec.get_rels(ctx)) {
+    CrelRecord rec = get_crel_record(ctx, isec, rel);
+
+    u8 flags = 0;
+    if (rec.symidx != prev.symidx)
+      flags |= 1;
+    if (pad_type || rec.type != prev.type)
+      flags |= 2;
+    if (crel_has_addend<E> && rec.addend != prev.addend)
+      flags |= 4;
+
+    // Offsets may go backwards, in which case the delta wraps around.
+    u64 delta = (rec.offset - prev.offset) >> shift;
+    u64 hi = delta >> (7 - nflags);
+    u8 lo = delta & ((1 << (7 - nflags)) - 1);
+
+    if (hi) {
+      put(0x80 | (lo << nflags) | flags);
+      put_uleb(hi);
+    } else {
+      put((lo << nflags) | flags);
+    }
+
+    if (flags & 1)
+      put_sleb(rec.symidx - prev.symidx);
+
+    if (flags & 2) {
+      i64 val = rec.type - prev.type;
+      if (pad_type) {
+        assert(-8192 <= val && val < 8192);
+        put((val & 0x7f) | 0x80);
+        put((val >> 7) & 0x7f);
+      } else {
+        put_sleb(val);
+      }
+    }
+
+    if (flags & 4)
+      put_sleb(rec.addend - prev.addend);
+
+    if (buf && ctx.arg.relocatable) {
+      u8 *base = ctx.buf + isec.output_section->shdr.sh_offset + isec.offset;
+      write_addend(base + rel.r_offset, rec.addend, rel);
+    }
+
+    prev = rec;
+  }
+  return size;
+}
+
+// Returns the record preceding the first relocation of each input section.
+template <typename E>
+static std::vector<CrelRecord>
+get_crel_start_records(Context<E> &ctx, std::span<ArenaPtr<InputSection<E>>> members) {
+  std::vector<CrelRecord> vec(members.size());
+
+  tbb::parallel_for((i64)0, (i64)members.size(), [&](i64 i) {
+    InputSection<E> &isec = *members[i];
+    std::span<ElfRel<E>> rels = isec.get_rels(ctx);
+    if (!rels.empty())
+      vec[i] = get_crel_record(ctx, isec, rels.back());
+  });
+
+  CrelRecord prev;
+  for (i64 i = 0; i < members.size(); i++) {
+    CrelRecord rec = vec[i];
+    vec[i] = prev;
+    if (!members[i]->get_rels(ctx).empty())
+      prev = rec;
+  }
+  return vec;
+}
+
+template <typename E>
+void RelocSection<E>::compute_crel_size(Context<E> &ctx) {
+  std::span<ArenaPtr<InputSection<E>>> members = output_section.members;
+
+  // All offsets are multiples of 1 << shift, which is stored in the
+  // header so that offset deltas can be encoded in fewer bits.
+  std::vector<u64> masks(members.size());
+
+  tbb::parallel_for((i64)0, (i64)members.size(), [&](i64 i) {
+    for (const ElfRel<E> &rel : members[i]->get_rels(ctx))
+      masks[i] |= get_output_offset(*members[i], rel);
+  });
+
+  u64 mask = 8;
+  i64 num_relocs = 0;
+  for (i64 i = 0; i < members.size(); i++) {
+    mask |= masks[i];
+    num_relocs += members[i]->get_rels(ctx).size();
+  }
+
+  i64 shift = std::countr_zero(mask);
+  crel_hdr = (num_relocs << 3) | (crel_has_addend<E> ? 4 : 0) | shift;
+
+  std::vector<CrelRecord> start = get_crel_start_records(ctx, members);
+  std::vector<i64> sizes(members.size());
+
+  tbb::parallel_for((i64)0, (i64)members.size(), [&](i64 i) {
+    sizes[i] = encode_crel(ctx, *members[i], start[i], shift,
+                           !ctx.arg.relocatable, nullptr);
+  });
+
+  i64 offset = uleb_size(crel_hdr);
+  offsets.resize(members.size());
+
+  for (i64 i = 0; i < members.size(); i++) {
+    offsets[i] = offset;
+    offset += sizes[i];
+  }
+  this->shdr.sh_size = offset;
+}
+
+template <typename E>
+void RelocSection<E>::copy_crel(Context<E> &ctx) {
+  std::span<ArenaPtr<InputSection<E>>> members = output_section.members;
+  u8 *buf = ctx.buf + this->shdr.sh_offset;
+  write_uleb(buf, crel_hdr);
+
+  // We need to recompute start records because relocation types may
+  // have been rewritten since compute_crel_size().
+  std::vector<CrelRecord> start = get_crel_start_records(ctx, members);
+
+  tbb::parallel_for((i64)0, (i64)members.size(), [&](i64 i) {
+    [[maybe_unused]] i64 size =
+      encode_crel(ctx, *members[i], start[i], crel_hdr & 3,
+                  !ctx.arg.relocatable, buf + offsets[i]);
+    assert(offsets[i] + size ==
+           (i + 1 < members.size() ? offsets[i + 1] : (i64)this->shdr.sh_size));
+  });
+}
+
 template <typename E>
 void ComdatGroupSection<E>::update_shdr(Context<E> &ctx) {
   assert(ctx.arg.relocatable);
@@ -3583,6 +4238,7 @@ template class GnuDebuglinkSection<E>;
 template Chunk<E> *find_chunk(Context<E> &, u32);
 template Chunk<E> *find_chunk(Context<E> &, std::string_view);
 template i64 to_phdr_flags(Context<E> &ctx, Chunk<E> *chunk);
+template bool is_hugepage_text(Context<E> &ctx, Chunk<E> *chunk);
 
 template std::optional<ElfSym<E>>
 to_output_esym(Context<E> &, Symbol<E> &, u32, U32<E> *);
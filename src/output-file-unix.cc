@@ -5,6 +5,7 @@
 #include <filesystem>
 #include <sys/file.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <system_error>
 
 #ifdef __linux__
@@ -54,6 +55,11 @@ public:
     if (fchmod(this->fd, perm & ~get_umask()) == -1)
       Fatal(ctx) << "fchmod failed: " << errno_string();
 
+    // If we are not reusing an existing file, the file is empty, and
+    // growing it with ftruncate fills it with zeros.
+    if (struct stat st; fstat(this->fd, &st) == 0 && st.st_size == 0)
+      this->is_zero_filled = true;
+
     if (ftruncate(this->fd, filesize) == -1)
       Fatal(ctx) << "ftruncate failed: " << errno_string();
 
@@ -136,6 +142,20 @@ public:
     return this->buf + mapsize;
   }
 
+  // Punch a hole instead of writing zeros to a large range to make the
+  // output file sparse. If we are overwriting an existing file, it saves
+  // us from dirtying pages. Otherwise, it releases disk blocks that we
+  // have preallocated with fallocate.
+  bool clear(Context<E> &ctx, i64 offset, i64 size) override {
+#if HAVE_FALLOCATE
+    if (size >= 65536 &&
+        fallocate(this->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                  offset, size) == 0)
+      return false;
+#endif
+    return OutputFile<E>::clear(ctx, offset, size);
+  }
+
   void close(Context<E> &ctx) override {
     Timer t(ctx, "close_file");
 
@@ -186,8 +206,10 @@ OutputFile<E>::open(Context<E> &ctx, std::string path, i64 filesize, int perm) {
   madvise(file->buf, filesize, MADV_HUGEPAGE);
 #endif
 
-  if (ctx.arg.filler != -1)
+  if (ctx.arg.filler != -1) {
     memset(file->buf, ctx.arg.filler, filesize);
+    file->is_zero_filled = false;
+  }
   return std::unique_ptr<OutputFile>(file);
 }
 
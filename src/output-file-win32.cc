@@ -30,6 +30,9 @@ public:
 
     CloseHandle(map);
 
+    // CREATE_ALWAYS always truncates an existing file.
+    this->is_zero_filled = true;
+
     mold::output_buffer_start = this->buf;
     mold::output_buffer_end = this->buf + filesize;
   }
@@ -105,8 +108,10 @@ OutputFile<E>::open(Context<E> &ctx, std::string path, i64 filesize, int perm) {
   else
     file = new MemoryMappedOutputFile(ctx, path, filesize, perm);
 
-  if (ctx.arg.filler != -1)
+  if (ctx.arg.filler != -1) {
     memset(file->buf, ctx.arg.filler, filesize);
+    file->is_zero_filled = false;
+  }
   return std::unique_ptr<OutputFile<E>>(file);
 }
 
@@ -513,6 +513,24 @@ void do_lto(Context<E> &ctx) {
   resolve_symbols(ctx);
 }
 
+// While the LTO plugin is generating code, we can do part of the work
+// for object files that are included in the output regardless of the
+// LTO result. The caller selects such files before starting LTO. This
+// function is called concurrently with do_lto(), so it must not touch
+// symbols, file reachability or `ctx.objs`, and it must not kill input
+// sections. That's why .sframe sections, which parse_sframe() kills, are
+// left to parse_sframe_sections().
+template <typename E>
+void preprocess_non_lto_objects(Context<E> &ctx,
+                                const std::vector<ObjectFile<E> *> &objs) {
+  Timer t(ctx, "preprocess_non_lto_objects");
+
+  tbb::parallel_for_each(objs, [&](ObjectFile<E> *file) {
+    file->read_ehframe_records(ctx);
+    file->split_mergeable_sections(ctx);
+  });
+}
+
 template <typename E>
 void parse_eh_frame_sections(Context<E> &ctx) {
   Timer t(ctx, "parse_eh_frame_sections");
@@ -528,7 +546,28 @@ void parse_sframe_sections(Context<E> &ctx) {
     Timer t(ctx, "parse_sframe_sections");
     tbb::parallel_for_each(ctx.objs, [&](ObjectFile<E> *file) {
       file->parse_sframe(ctx);
+      if (ctx.arg.synthesize_sframe && file->sframe_fdes.empty())
+        file->synthesize_sframe(ctx);
     });
+
+    std::string &path = ctx.arg.print_sframe_failures;
+
+    if (!path.empty()) {
+      std::ostream *out = &std::cout;
+      std::ofstream file;
+
+      if (path != "-") {
+        file.open(path);
+        if (file.fail())
+          Fatal(ctx) << "--print-sframe-failures: cannot open " << path
+                     << ": " << errno_string();
+        out = &file;
+      }
+
+      for (ObjectFile<E> *obj : ctx.objs)
+        for (std::string &msg : obj->sframe_failures)
+          *out << "cannot synthesize .sframe for " << msg << '\n';
+    }
   }
 }
 
@@ -718,6 +757,19 @@ void create_output_sections(Context<E> &ctx) {
   bool ctors_in_init_array = has_ctors_and_init_array(ctx);
   tbb::enumerable_thread_specific<MapType> caches;
 
+  // Input sections of each file paired with their output sections.
+  // We don't append input sections directly to output sections because
+  // that requires either a lock or a per-file bucket in each output
+  // section. The latter is quadratic if there are many output sections,
+  // which is the case for -r with -ffunction-sections inputs.
+  std::vector<std::vector<std::pair<OutputSection<E> *, InputSection<E> *>>>
+    vec(ctx.objs.size());
+
+  // Consecutive runs of the same output section in `vec`. The second
+  // member is first a run length and then the run's offset in `members`.
+  std::vector<std::vector<std::pair<OutputSection<E> *, i64>>>
+    runs(ctx.objs.size());
+
   // Instantiate output sections and assign input sections to them
   tbb::parallel_for((i64)0, (i64)ctx.objs.size(), [&](i64 i) {
     // Make a per-thread cache of the main map to avoid lock contention.
@@ -736,8 +788,8 @@ void create_output_sections(Context<E> &ctx) {
         OutputSection<E> *osec =
           ctx.arena.template make<OutputSection<E>>(isec->name(), shdr.sh_type);
         osec->sh_flags = sh_flags;
-        osec->members_vec.push_back({isec});
         isec->output_section = osec;
+        vec[i].push_back({osec, isec});
 
         std::scoped_lock lock(mu);
         ctx.osec_pool.emplace_back(osec);
@@ -757,7 +809,6 @@ void create_output_sections(Context<E> &ctx) {
         if (inserted) {
           OutputSection<E> *osec =
             ctx.arena.template make<OutputSection<E>>(key.name, key.type);
-          osec->members_vec.resize(ctx.objs.size());
           ctx.osec_pool.emplace_back(osec);
           it->second = osec;
         }
@@ -771,43 +822,57 @@ void create_output_sections(Context<E> &ctx) {
       if ((osec->sh_flags & sh_flags) != sh_flags)
         osec->sh_flags |= sh_flags;
       isec->output_section = osec;
-      osec->members_vec[i].push_back(isec);
+      vec[i].push_back({osec, isec});
     }
-  });
 
-  // Compute section alignment
-  tbb::parallel_for_each(ctx.osec_pool, [](ArenaObjectPtr<OutputSection<E>> &osec) {
-    Atomic<u32> p2align;
-    tbb::parallel_for((i64)0, (i64)osec->members_vec.size(), [&](i64 i) {
-      u32 x = 0;
-      for (InputSection<E> *isec : osec->members_vec[i])
-        x = std::max<u32>(x, isec->p2align);
-      update_maximum(p2align, x);
-    });
-    osec->shdr.sh_addralign = 1 << p2align;
+    // Group input sections by output section while keeping their
+    // relative order.
+    ranges::stable_sort(vec[i], {}, [](auto &p) { return p.first; });
+
+    for (i64 j = 0; j < vec[i].size(); j++) {
+      if (j == 0 || vec[i][j - 1].first != vec[i][j].first)
+        runs[i].push_back({vec[i][j].first, 0});
+      runs[i].back().second++;
+    }
   });
 
-  // Flatten members_vec into an arena-allocated members array
-  for (ArenaObjectPtr<OutputSection<E>> &osec : ctx.osec_pool) {
+  // Reserve a range of each output section's members for each file.
+  // This is a serial loop, but it visits each (file, output section)
+  // pair only once.
+  for (i64 i = 0; i < ctx.objs.size(); i++) {
+    for (auto &[osec, n] : runs[i]) {
+      i64 base = osec->num_members;
+      osec->num_members += n;
+      n = base;
+    }
+  }
+
+  tbb::parallel_for_each(ctx.osec_pool, [&](ArenaObjectPtr<OutputSection<E>> &osec) {
     osec->shdr.sh_flags = osec->sh_flags;
     osec->is_relro = is_relro(*osec);
 
-    i64 n = 0;
-    for (std::vector<InputSection<E> *> &vec : osec->members_vec)
-      n += vec.size();
-
     ArenaPtr<InputSection<E>> *array =
-      ctx.arena.template allocate<ArenaPtr<InputSection<E>>>(n);
+      ctx.arena.template allocate<ArenaPtr<InputSection<E>>>(osec->num_members);
+    osec->members = {array, (size_t)osec->num_members};
+  });
 
-    i64 idx = 0;
-    for (std::vector<InputSection<E> *> &vec : osec->members_vec)
-      for (InputSection<E> *isec : vec)
-        std::construct_at(array + idx++, isec);
+  // Fill the members arrays and compute section alignment
+  tbb::parallel_for((i64)0, (i64)ctx.objs.size(), [&](i64 i) {
+    i64 j = 0;
+    for (auto [osec, base] : runs[i]) {
+      u8 p2align = 0;
+      for (i64 k = base; j < vec[i].size() && vec[i][j].first == osec; j++, k++) {
+        InputSection<E> *isec = vec[i][j].second;
+        std::construct_at(&osec->members[k], isec);
+        p2align = std::max<u8>(p2align, isec->p2align);
+      }
+      update_maximum(osec->p2align, p2align);
+    }
+  });
 
-    osec->members = {array, (size_t)n};
-    osec->members_vec.clear();
-    osec->members_vec.shrink_to_fit();
-  }
+  tbb::parallel_for_each(ctx.osec_pool, [](ArenaObjectPtr<OutputSection<E>> &osec) {
+    osec->shdr.sh_addralign = 1 << osec->p2align;
+  });
 
   // Add output sections and mergeable sections to ctx.chunks
   std::vector<Chunk<E> *> chunks;
@@ -1726,26 +1791,29 @@ static void shuffle(std::span<ArenaPtr<InputSection<E>>> vec, u64 seed) {
     ranges::swap(vec[i], vec[i + rand() % (vec.size() - i)]);
 }
 
+// Returns true if the order of input sections in a given output section
+// doesn't matter for the program's semantics.
+template <typename E>
+static bool is_reorderable(OutputSection<E> *osec) {
+  if (osec) {
+    std::string_view name = osec->name;
+    return (osec->shdr.sh_flags & SHF_ALLOC) &&
+           name != ".init" && name != ".fini" &&
+           name != ".ctors" && name != ".dtors" &&
+           name != ".init_array" && name != ".preinit_array" &&
+           name != ".fini_array";
+  }
+  return false;
+}
+
 template <typename E>
 void shuffle_sections(Context<E> &ctx) {
   Timer t(ctx, "shuffle_sections");
 
-  auto is_eligible = [](OutputSection<E> *osec) {
-    if (osec) {
-      std::string_view name = osec->name;
-      return (osec->shdr.sh_flags & SHF_ALLOC) &&
-             name != ".init" && name != ".fini" &&
-             name != ".ctors" && name != ".dtors" &&
-             name != ".init_array" && name != ".preinit_array" &&
-             name != ".fini_array";
-    }
-    return false;
-  };
-
   switch (ctx.arg.shuffle_sections) {
   case SHUFFLE_SECTIONS_SHUFFLE: {
     tbb::parallel_for_each(ctx.chunks, [&](Chunk<E> *chunk) {
-      if (OutputSection<E> *osec = chunk->to_osec(); is_eligible(osec)) {
+      if (OutputSection<E> *osec = chunk->to_osec(); is_reorderable(osec)) {
         u64 seed = ctx.arg.shuffle_sections_seed + hash_string(osec->name);
         shuffle(osec->members, seed);
       }
@@ -1754,7 +1822,7 @@ void shuffle_sections(Context<E> &ctx) {
   }
   case SHUFFLE_SECTIONS_REVERSE:
     tbb::parallel_for_each(ctx.chunks, [&](Chunk<E> *chunk) {
-      if (OutputSection<E> *osec = chunk->to_osec(); is_eligible(osec))
+      if (OutputSection<E> *osec = chunk->to_osec(); is_reorderable(osec))
         ranges::reverse(osec->members);
     });
     break;
@@ -1763,6 +1831,73 @@ void shuffle_sections(Context<E> &ctx) {
   }
 }
 
+// Handle --hot-data-file. Data objects are usually laid out in the input
+// file order, so objects that are accessed together at runtime may be
+// scattered across many cache lines and pages. This function moves the
+// input sections containing hot objects to the beginning of each data
+// output section in the order given by the user.
+//
+// An object that is frequently written to is aligned to a cache line
+// boundary, and so is the section following it, so that it doesn't cause
+// false sharing with its neighbors.
+template <typename E>
+void sort_hot_data_sections(Context<E> &ctx) {
+  Timer t(ctx, "sort_hot_data_sections");
+  constexpr u8 CACHE_LINE_P2ALIGN = 6;
+
+  struct Rank {
+    i64 rank;
+    bool is_write_hot;
+  };
+
+  std::unordered_map<InputSection<E> *, Rank> ranks;
+
+  for (i64 i = 0; auto [sym, is_write_hot] : ctx.arg.hot_data_symbols) {
+    InputSection<E> *isec = sym->get_input_section();
+    if (!isec || !isec->is_alive() || !isec->output_section)
+      continue;
+
+    if (isec->shdr().sh_flags & SHF_EXECINSTR)
+      continue;
+
+    auto [it, inserted] = ranks.insert({isec, {i++, is_write_hot}});
+    if (!inserted)
+      it->second.is_write_hot |= is_write_hot;
+  }
+
+  auto get_rank = [&](InputSection<E> *isec) -> i64 {
+    auto it = ranks.find(isec);
+    return (it == ranks.end()) ? INT64_MAX : it->second.rank;
+  };
+
+  tbb::parallel_for_each(ctx.chunks, [&](Chunk<E> *chunk) {
+    OutputSection<E> *osec = chunk->to_osec();
+    if (!is_reorderable(osec) || (osec->shdr.sh_flags & SHF_EXECINSTR))
+      return;
+
+    // Sort a copy because stable_sort may move ArenaPtrs to a temporary
+    // buffer far away from their targets.
+    std::vector<InputSection<E> *> vec(osec->members.begin(), osec->members.end());
+    ranges::stable_sort(vec, {}, get_rank);
+    for (i64 i = 0; i < vec.size(); i++)
+      osec->members[i] = vec[i];
+
+    for (i64 i = 0; i < vec.size(); i++) {
+      auto it = ranks.find(vec[i]);
+      if (it == ranks.end())
+        break;
+
+      if (it->second.is_write_hot) {
+        update_maximum(vec[i]->p2align, CACHE_LINE_P2ALIGN);
+        if (i + 1 < vec.size())
+          update_maximum(vec[i + 1]->p2align, CACHE_LINE_P2ALIGN);
+        update_maximum(osec->p2align, CACHE_LINE_P2ALIGN);
+        osec->shdr.sh_addralign = 1 << osec->p2align;
+      }
+    }
+  });
+}
+
 template <typename E>
 void add_dynamic_strings(Context<E> &ctx) {
   for (SharedFile<E> *file : ctx.dsos) {
@@ -1947,57 +2082,78 @@ void scan_relocations(Context<E> &ctx) {
   if (ctx.needs_tlsld)
     ctx.got->add_tlsld(ctx);
 
-  // Assign offsets in additional tables for each dynamic symbol.
-  for (Symbol<E> *sym : syms) {
-    if (!sym->aux)
-      sym->aux = ctx.arena.template make<SymbolAux<E>>();
+  // Assign offsets in additional tables for each dynamic symbol. Each
+  // table is filled in parallel, in the order of `syms`, so that the
+  // output is deterministic.
+  auto is_canonical_plt = [](Symbol<E> *sym) {
+    return (sym->flags & NEEDS_CANONICAL) && sym->get_type() == STT_FUNC;
+  };
 
-    if (sym->is_imported || sym->is_exported)
-      ctx.dynsym->add_symbol(ctx, sym);
+  auto is_copyrel = [](Symbol<E> *sym) {
+    return (sym->flags & NEEDS_CANONICAL) && sym->get_type() != STT_FUNC;
+  };
 
-    if (sym->flags & NEEDS_GOT)
-      ctx.got->add_got_symbol(ctx, sym);
+  auto needs_plt = [&](Symbol<E> *sym) {
+    return is_canonical_plt(sym) ||
+           ((sym->flags & NEEDS_PLT) && !(sym->flags & NEEDS_GOT));
+  };
 
-    if ((sym->flags & NEEDS_CANONICAL) && sym->get_type() == STT_FUNC) {
-      sym->is_canonical = true;
+  auto needs_pltgot = [&](Symbol<E> *sym) {
+    return !is_canonical_plt(sym) && (sym->flags & NEEDS_PLT) &&
+           (sym->flags & NEEDS_GOT);
+  };
 
-      // A canonical PLT needs to be visible from DSOs.
-      sym->is_exported = true;
+  auto needs_dynsym = [&](Symbol<E> *sym) {
+    return sym->is_imported || sym->is_exported || needs_plt(sym);
+  };
 
-      // We can't use .plt.got for a canonical PLT because otherwise
-      // .plt.got and .got would refer to each other, resulting in an
-      // infinite loop at runtime.
-      ctx.plt->add_symbol(ctx, sym);
-    } else if (sym->flags & NEEDS_PLT) {
-      if (sym->flags & NEEDS_GOT)
-        ctx.pltgot->add_symbol(ctx, sym);
-      else
-        ctx.plt->add_symbol(ctx, sym);
-    }
+  tbb::parallel_for_each(syms, [&](Symbol<E> *sym) {
+    if (!sym->aux)
+      sym->aux = ctx.arena.template make<SymbolAux<E>>();
+  });
 
-    if (sym->flags & NEEDS_GOTTP)
-      ctx.got->add_gottp_symbol(ctx, sym);
+  std::vector<Symbol<E> *> copyrel_syms = parallel_filter(syms, is_copyrel);
 
-    if (sym->flags & NEEDS_TLSGD)
-      ctx.got->add_tlsgd_symbol(ctx, sym);
+  if (copyrel_syms.empty()) {
+    ctx.dynsym->add_symbols(ctx, parallel_filter(syms, needs_dynsym));
+  } else {
+    // A copy relocation adds the symbol's aliases to .dynsym too, so
+    // .dynsym and copy relocations are handled in a single pass.
+    for (Symbol<E> *sym : syms) {
+      if (needs_dynsym(sym))
+        ctx.dynsym->add_symbol(ctx, sym);
+
+      if (is_copyrel(sym)) {
+        if (ctx.arg.z_relro && sym->file->is_dso &&
+            sym->file->to_dso()->is_readonly(sym))
+          ctx.copyrel_relro->add_symbol(ctx, sym);
+        else
+          ctx.copyrel->add_symbol(ctx, sym);
+      }
+    }
+  }
 
-    if (sym->flags & NEEDS_TLSDESC)
-      ctx.got->add_tlsdesc_symbol(ctx, sym);
+  ctx.got->add_symbols(ctx, syms);
 
-    if ((sym->flags & NEEDS_CANONICAL) && sym->get_type() != STT_FUNC) {
-      if (ctx.arg.z_relro && sym->file->is_dso &&
-          sym->file->to_dso()->is_readonly(sym))
-        ctx.copyrel_relro->add_symbol(ctx, sym);
-      else
-        ctx.copyrel->add_symbol(ctx, sym);
-    }
+  // We can't use .plt.got for a canonical PLT because otherwise
+  // .plt.got and .got would refer to each other, resulting in an
+  // infinite loop at runtime.
+  ctx.plt->add_symbols(ctx, parallel_filter(syms, needs_plt));
+  ctx.pltgot->add_symbols(ctx, parallel_filter(syms, needs_pltgot));
 
-    if constexpr (is_ppc64v1<E>)
+  if constexpr (is_ppc64v1<E>)
+    for (Symbol<E> *sym : syms)
       if (sym->flags & NEEDS_PPC_OPD)
         ctx.extra.opd->add_symbol(ctx, sym);
 
+  tbb::parallel_for_each(syms, [&](Symbol<E> *sym) {
+    // A canonical PLT needs to be visible from DSOs.
+    if (is_canonical_plt(sym)) {
+      sym->is_canonical = true;
+      sym->is_exported = true;
+    }
     sym->flags = 0;
-  }
+  });
 
   if (ctx.has_textrel && ctx.arg.warn_textrel)
     Warn(ctx) << "creating a DT_TEXTREL in an output file";
@@ -2076,12 +2232,37 @@ void create_reloc_sections(Context<E> &ctx) {
         ctx.chunks.push_back(x);
 }
 
+// With -z crel, relocation sections are written in a variable-length
+// encoding, so their sizes can be computed only after section indices,
+// symbol table indices and the memory layout are fixed.
+template <typename E>
+void compute_crel_sizes(Context<E> &ctx) {
+  Timer t(ctx, "compute_crel_sizes");
+
+  tbb::parallel_for_each(ctx.chunks, [&](Chunk<E> *chunk) {
+    if (RelocSection<E> *sec = chunk->to_reloc_sec())
+      sec->compute_crel_size(ctx);
+  });
+}
+
 // Copy chunks to an output file
 template <typename E>
 void copy_chunks(Context<E> &ctx) {
   Timer t(ctx, "copy_chunks");
 
+  // A timer costs a few system calls, which is not negligible if there
+  // are hundreds of thousands of chunks as is often the case with -r.
+  // Per-chunk numbers aren't useful in such case anyway. If you change
+  // this limit, update the description of --perf in docs/mold.md too.
+  constexpr i64 MAX_CHUNK_TIMERS = 1000;
+  bool use_timer = ctx.arg.perf && ctx.chunks.size() <= MAX_CHUNK_TIMERS;
+
   auto copy = [&](Chunk<E> &chunk) {
+    if (!use_timer) {
+      chunk.copy_buf(ctx);
+      return;
+    }
+
     std::string name = chunk.name.empty() ? "(header)" : std::string(chunk.name);
     Timer t2(ctx, name, &t);
     chunk.copy_buf(ctx);
@@ -2103,26 +2284,129 @@ void copy_chunks(Context<E> &ctx) {
            chunk.to_reloc_sec();
   };
 
-  tbb::parallel_for_each(ctx.chunks, [&](Chunk<E> *chunk) {
-    if (!copy_last(*chunk))
-      copy(*chunk);
+  // A relocation section that refers to its target section by sh_info
+  // needs to wait only for that section. Others (e.g. REL-type dynamic
+  // relocations) may write to any section, so they are copied after all
+  // the other chunks are done.
+  std::unordered_map<i64, Chunk<E> *> shndx_map;
+  for (Chunk<E> *chunk : ctx.chunks)
+    if (chunk->shndx)
+      shndx_map[chunk->shndx] = chunk;
+
+  struct Task {
+    Chunk<E> *chunk = nullptr;
+    std::vector<Chunk<E> *> deps;
+    i64 cost = 0;
+  };
+
+  std::vector<Task> tasks;
+  std::unordered_map<Chunk<E> *, i64> task_idx;
+  std::vector<Chunk<E> *> last;
+
+  for (Chunk<E> *chunk : ctx.chunks) {
+    if (!copy_last(*chunk)) {
+      task_idx[chunk] = tasks.size();
+      tasks.push_back({chunk});
+    }
+  }
+
+  for (Chunk<E> *chunk : ctx.chunks) {
+    if (copy_last(*chunk)) {
+      Chunk<E> *target = nullptr;
+      if (chunk->shdr.sh_flags & SHF_INFO_LINK)
+        if (auto it = shndx_map.find(chunk->shdr.sh_info); it != shndx_map.end())
+          target = it->second;
+
+      if (auto it = task_idx.find(target); target && it != task_idx.end())
+        tasks[it->second].deps.push_back(chunk);
+      else
+        last.push_back(chunk);
+    }
+  }
+
+  // Estimate the time to copy each chunk from its size and the number
+  // of relocations to be applied to it. Applying a relocation costs
+  // about as much as copying a hundred bytes, so we weigh the size of
+  // relocation sections four times.
+  auto get_cost = [&](Chunk<E> *chunk) {
+    i64 cost = 0;
+    if (chunk->shdr.sh_type != SHT_NOBITS)
+      cost = chunk->shdr.sh_size;
+    if (OutputSection<E> *osec = chunk->to_osec())
+      for (InputSection<E> *isec : osec->members)
+        if (isec->relsec_idx != -1)
+          cost += isec->file->elf_sections[isec->relsec_idx].sh_size * 4;
+    return cost;
+  };
+
+  tbb::parallel_for_each(tasks, [&](Task &task) {
+    task.cost = get_cost(task.chunk);
+    for (Chunk<E> *chunk : task.deps)
+      task.cost += get_cost(chunk);
   });
 
-  tbb::parallel_for_each(ctx.chunks, [&](Chunk<E> *chunk) {
-    if (copy_last(*chunk))
+  // Start from the most expensive chunk so that a large chunk doesn't
+  // become the tail while other threads are idle. Each iteration takes
+  // the next task from the sorted list rather than the i-th one because
+  // TBB doesn't start iterations in index order.
+  ranges::stable_sort(tasks, std::greater(), &Task::cost);
+
+  std::atomic<i64> next_task = 0;
+
+  // For --perf, "(tail)" is the time from when the last task is started
+  // until all tasks are done, and "(idle)" is the average time a thread
+  // had nothing to do in this loop. Chunks are copied with nested
+  // parallel loops, and a thread may spend the tail running someone
+  // else's nested tasks, so we can't tell if a thread is busy from the
+  // outer loop. Instead, we sum up the CPU time of all threads.
+  std::optional<Timer<Context<E>>> t_tail;
+  i64 start_nsec = ctx.arg.perf ? now_nsec() : 0;
+  i64 start_cpu = ctx.arg.perf ? get_process_cpu_time() : 0;
+
+  tbb::parallel_for((i64)0, (i64)tasks.size(), [&](i64) {
+    i64 i = next_task++;
+    if (ctx.arg.perf && i == tasks.size() - 1)
+      t_tail.emplace(ctx, "(tail)", &t);
+
+    copy(*tasks[i].chunk);
+    for (Chunk<E> *chunk : tasks[i].deps)
       copy(*chunk);
   });
 
+  t_tail.reset();
+
+  if (ctx.arg.perf) {
+    i64 nthreads = tbb::this_task_arena::max_concurrency();
+    i64 total = (now_nsec() - start_nsec) * nthreads;
+    i64 busy = get_process_cpu_time() - start_cpu;
+    t.add_child(ctx, "(idle)", std::max<i64>(total - busy, 0) / nthreads);
+  }
+
+  tbb::parallel_for_each(last, [&](Chunk<E> *chunk) {
+    copy(*chunk);
+  });
+
   // Undefined symbols in SHF_ALLOC sections are found by scan_relocations(),
   // but those in non-SHF_ALLOC sections cannot be found until we copy section
   // contents. So we need to call this function again to report possible
   // undefined errors.
   report_undef_errors(ctx);
 
-  // Zero-clear paddings between chunks
+  // Zero-clear paddings between chunks. For --stats, we count the
+  // number of 4 KiB pages the paddings span.
+  static Counter dirty_pages("padding_dirty_pages");
+  static Counter skipped_pages("padding_skipped_pages");
+
   auto zero = [&](Chunk<E> *chunk, i64 next_start) {
     i64 pos = chunk->shdr.sh_offset + chunk->shdr.sh_size;
-    memset(ctx.buf + pos, 0, next_start - pos);
+    if (pos >= next_start)
+      return;
+
+    i64 npages = align_to(next_start, 4096) / 4096 - pos / 4096;
+    if (ctx.output_file->clear(ctx, pos, next_start - pos))
+      dirty_pages += npages;
+    else
+      skipped_pages += npages;
   };
 
   std::vector<Chunk<E> *> chunks = ctx.chunks;
@@ -2166,7 +2450,7 @@ void sort_dynsyms(Context<E> &ctx) {
 
     // Count the number of exported symbols to compute the size of .gnu.hash.
     i64 num_exported = exported_syms.size();
-    u32 num_buckets = num_exported / ctx.gnu_hash->LOAD_FACTOR + 1;
+    u32 num_buckets = num_exported / ctx.arg.hash_load_factor + 1;
 
     tbb::parallel_for_each(exported_syms, [&](Symbol<E> *sym) {
       sym->aux->djb_hash = djb_hash(sym->name());
@@ -2181,16 +2465,12 @@ void sort_dynsyms(Context<E> &ctx) {
     ctx.gnu_hash->num_exported = num_exported;
   }
 
-  // Compute .dynstr size
-  ctx.dynsym->dynstr_offset = ctx.dynstr->shdr.sh_size;
-
-  tbb::enumerable_thread_specific<i64> size;
   tbb::parallel_for((i64)1, (i64)syms.size(), [&](i64 i) {
     syms[i]->aux->dynsym_idx = i;
-    size.local() += syms[i]->name().size() + 1;
   });
 
-  ctx.dynstr->shdr.sh_size += size.combine(std::plus());
+  // Compute .dynstr size
+  ctx.dynstr->add_dynsym_names(ctx);
 
   // ELF's symbol table sh_info holds the offset of the first global symbol.
   ctx.dynsym->shdr.sh_info = globals.begin() - syms.begin();
@@ -2221,6 +2501,43 @@ void create_output_symtab(Context<E> &ctx) {
   });
 }
 
+// Returns the demangled name of a symbol, or the symbol name itself if
+// it is not a mangled C++ name. Results are cached in the arena, so each
+// symbol is demangled at most once per link even if we match patterns
+// both before and after LTO. `shard` and `idx` are the symbol's position
+// in the symbol map, and entries are visited in increasing `idx` order.
+template <typename E>
+static std::string_view
+get_demangled_name(Context<E> &ctx, Symbol<E> &sym, i64 shard, i64 idx,
+                   bool is_needed) {
+  // 0 means that the name is not mangled. 1 is never a valid arena index
+  // and marks entries that we have not looked at yet.
+  static constexpr u32 NOT_MANGLED = 0;
+  static constexpr u32 UNKNOWN = 1;
+
+  std::vector<u32> &cache = ctx.demangled_names[shard];
+  if (cache.size() <= idx)
+    cache.resize(idx + 1, UNKNOWN);
+
+  if (!is_needed || cache[idx] == NOT_MANGLED)
+    return sym.name();
+
+  if (cache[idx] != UNKNOWN)
+    return ctx.arena.template get_pointer<char>(cache[idx]);
+
+  std::optional<std::string_view> s = demangle_cpp(sym.name());
+  if (!s) {
+    cache[idx] = NOT_MANGLED;
+    return sym.name();
+  }
+
+  char *buf = ctx.arena.template allocate<char>(s->size() + 1);
+  memcpy(buf, s->data(), s->size());
+  buf[s->size()] = '\0';
+  cache[idx] = ctx.arena.get_index(buf);
+  return {buf, s->size()};
+}
+
 template <typename E>
 void apply_version_script(Context<E> &ctx) {
   Timer t(ctx, "apply_version_script");
@@ -2258,25 +2575,57 @@ void apply_version_script(Context<E> &ctx) {
     }
   }
 
-  if (!matcher.empty() || !cpp_matcher.empty()) {
-    ctx.symbol_map.parallel_for_each([&](Symbol<E> &sym) {
+  // Wildcard and `extern "C++"` patterns of --dynamic-list and the like
+  // are matched in the same walk over the symbol table, so that each
+  // symbol's name is demangled at most once per link.
+  Glob dyn_matcher;
+  Glob dyn_cpp_matcher;
+
+  for (DynamicPattern &p : ctx.dynamic_list_patterns) {
+    if (p.is_cpp) {
+      if (!dyn_cpp_matcher.add(p.pattern, 1))
+        Fatal(ctx) << p.source << ": invalid dynamic list entry: "
+                   << p.pattern;
+    } else if (has_wildcard(p.pattern)) {
+      if (!dyn_matcher.add(p.pattern, 1))
+        Fatal(ctx) << p.source << ": invalid dynamic list entry: "
+                   << p.pattern;
+    }
+  }
+
+  ctx.dynamic_list_syms.clear();
+
+  if (!matcher.empty() || !cpp_matcher.empty() ||
+      !dyn_matcher.empty() || !dyn_cpp_matcher.empty()) {
+    Timer t2(ctx, "match_symbol_patterns", &t);
+    bool need_demangle = !cpp_matcher.empty() || !dyn_cpp_matcher.empty();
+    tbb::enumerable_thread_specific<std::vector<Symbol<E> *>> dyn_syms;
+
+    ctx.symbol_map.parallel_for_each_indexed([&](Symbol<E> &sym, i64 shard,
+                                                 i64 idx) {
       if (!sym.file || sym.file->is_dso)
         return;
 
-      std::string_view name = sym.name();
-      i64 match = matcher.find(name);
-
       // Match non-mangled symbols against the C++ pattern as well.
       // Weird, but required to match other linkers' behavior.
-      if (!cpp_matcher.empty()) {
-        if (std::optional<std::string_view> s = demangle_cpp(name))
-          name = *s;
-        match = std::max(match, cpp_matcher.find(name));
-      }
+      std::string_view name = sym.name();
+      std::string_view cpp_name =
+        get_demangled_name(ctx, sym, shard, idx, need_demangle);
+
+      i64 match = matcher.find(name);
+      if (!cpp_matcher.empty())
+        match = std::max(match, cpp_matcher.find(cpp_name));
 
       if (match != -1)
         sym.ver_idx = patterns[match].ver_idx;
+
+      if (dyn_matcher.find(name) != -1 ||
+          (!dyn_cpp_matcher.empty() && dyn_cpp_matcher.find(cpp_name) != -1))
+        dyn_syms.local().push_back(&sym);
     });
+
+    for (std::vector<Symbol<E> *> &vec : dyn_syms)
+      append(ctx.dynamic_list_syms, vec);
   }
 
   // Next, assign versions to symbols specified by exact name.
@@ -2455,9 +2804,6 @@ void compute_import_export(Context<E> &ctx) {
   // exported so that they are interposable. In other words, symbols
   // that did not match will be bound locally within the output file,
   // effectively turning them into protected symbols.
-  Glob matcher;
-  Glob cpp_matcher;
-
   auto handle_match = [&](Symbol<E> *sym) {
     if (ctx.arg.shared) {
       if (sym->is_exported)
@@ -2468,43 +2814,15 @@ void compute_import_export(Context<E> &ctx) {
     }
   };
 
-  for (DynamicPattern &p : ctx.dynamic_list_patterns) {
-    if (p.is_cpp) {
-      if (!cpp_matcher.add(p.pattern, 1))
-        Fatal(ctx) << p.source << ": invalid dynamic list entry: "
-                   << p.pattern;
-      continue;
-    }
+  for (DynamicPattern &p : ctx.dynamic_list_patterns)
+    if (!p.is_cpp && p.pattern.find_first_of("*?[") == p.pattern.npos)
+      handle_match(get_symbol(ctx, p.pattern));
 
-    if (p.pattern.find_first_of("*?[") != p.pattern.npos) {
-      if (!matcher.add(p.pattern, 1))
-        Fatal(ctx) << p.source << ": invalid dynamic list entry: "
-                   << p.pattern;
-      continue;
-    }
-
-    handle_match(get_symbol(ctx, p.pattern));
-  }
-
-  if (!matcher.empty() || !cpp_matcher.empty()) {
-    ctx.symbol_map.parallel_for_each([&](Symbol<E> &sym) {
-      if (!sym.file || sym.file->is_dso)
-        return;
-      if (ctx.arg.shared && !sym.is_exported)
-        return;
-
-      std::string_view name = sym.name();
-
-      if (matcher.find(name) != -1) {
-        handle_match(&sym);
-      } else if (!cpp_matcher.empty()) {
-        if (std::optional<std::string_view> s = demangle_cpp(name))
-          name = *s;
-        if (cpp_matcher.find(name) != -1)
-          handle_match(&sym);
-      }
-    });
-  }
+  // Symbols matched by wildcard or C++ patterns were collected by
+  // apply_version_script().
+  tbb::parallel_for_each(ctx.dynamic_list_syms, [&](Symbol<E> *sym) {
+    handle_match(sym);
+  });
 }
 
 // Compute the "address-taken" bit for each input section.
@@ -2706,12 +3024,30 @@ void sort_output_sections_regular(Context<E> &ctx) {
       return 3;
     if (chunk == ctx.relro_padding)
       return INT64_MAX;
+
+    // -z hugepage-text puts hot text at the end of executable sections
+    // so that it forms a contiguous region.
+    if (is_hugepage_text(ctx, chunk))
+      return (chunk->name == ".text.hot") ? 4 : 5;
     return 0;
   };
 
-  ranges::stable_sort(ctx.chunks, {}, [&](Chunk<E> *x) {
-    return std::tuple{get_rank1(x), get_rank2(x), x->name};
+  // Compute sort keys only once for each chunk. Using the original
+  // index as a tie-breaker makes the parallel sort stable.
+  std::vector<std::tuple<i64, i64, std::string_view, i64>> keys(ctx.chunks.size());
+
+  tbb::parallel_for((i64)0, (i64)ctx.chunks.size(), [&](i64 i) {
+    Chunk<E> *x = ctx.chunks[i];
+    keys[i] = {get_rank1(x), get_rank2(x), x->name, i};
   });
+
+  tbb::parallel_sort(keys);
+
+  std::vector<Chunk<E> *> vec;
+  vec.reserve(keys.size());
+  for (auto &key : keys)
+    vec.push_back(ctx.chunks[std::get<3>(key)]);
+  ctx.chunks = std::move(vec);
 }
 
 template <typename E>
@@ -2769,6 +3105,8 @@ void sort_output_sections_by_order(Context<E> &ctx) {
 
 template <typename E>
 void sort_output_sections(Context<E> &ctx) {
+  Timer t(ctx, "sort_output_sections");
+
   if (ctx.arg.section_order.empty())
     sort_output_sections_regular(ctx);
   else
@@ -2890,6 +3228,12 @@ static void set_virtual_addresses_regular(Context<E> &ctx) {
       }
     }
 
+    // Hot text for -z hugepage-text starts and ends at huge page
+    // boundaries so that it doesn't share huge pages with other sections.
+    if (i > 0 && is_hugepage_text(ctx, chunks[i - 1]) !=
+                 is_hugepage_text(ctx, chunks[i]))
+      addr = align_to(addr, HUGE_PAGE_SIZE);
+
     // TLS sections are included only in PT_LOAD but also in PT_TLS.
     // We align the first TLS section so that the PT_TLS segment starts
     // at an address that meets the segment's alignment requirement.
@@ -3021,7 +3365,9 @@ static i64 set_file_offsets(Context<E> &ctx) {
       continue;
     }
 
-    if (first.shdr.sh_addralign > ctx.page_size)
+    if (is_hugepage_text(ctx, &first))
+      fileoff = align_with_skew(fileoff, HUGE_PAGE_SIZE, first.shdr.sh_addr);
+    else if (first.shdr.sh_addralign > ctx.page_size)
       fileoff = align_to(fileoff, first.shdr.sh_addralign);
     else
       fileoff = align_with_skew(fileoff, ctx.page_size, first.shdr.sh_addr);
@@ -3043,6 +3389,10 @@ static i64 set_file_offsets(Context<E> &ctx) {
       if (chunks[i]->shdr.sh_addr < first.shdr.sh_addr)
         break;
 
+      // Hot text for -z hugepage-text is in its own segment.
+      if (is_hugepage_text(ctx, chunks[i]) != is_hugepage_text(ctx, &first))
+        break;
+
       // This section requires larger alignment, we need to adjust the
       // offset to ensure offset % align == vaddr % align.
       if (chunks[i]->shdr.sh_addralign > ctx.page_size &&
@@ -3061,6 +3411,11 @@ static i64 set_file_offsets(Context<E> &ctx) {
 
     fileoff = chunks[i - 1]->shdr.sh_offset + chunks[i - 1]->shdr.sh_size;
 
+    // The segment for -z hugepage-text is padded to a huge page boundary
+    // in the file as well.
+    if (is_hugepage_text(ctx, &first))
+      fileoff = align_to(fileoff, HUGE_PAGE_SIZE);
+
     while (i < chunks.size() &&
            (chunks[i]->shdr.sh_flags & SHF_ALLOC) &&
            chunks[i]->shdr.sh_type == SHT_NOBITS) {
@@ -3091,6 +3446,8 @@ void separate_debug_sections(Context<E> &ctx) {
 
 template <typename E>
 void compute_section_headers(Context<E> &ctx) {
+  Timer t(ctx, "compute_section_headers");
+
   // Update sh_size for each chunk.
   for (Chunk<E> *chunk : ctx.chunks)
     chunk->update_shdr(ctx);
@@ -3720,6 +4077,10 @@ void show_stats(Context<E> &ctx) {
         alloc += sec->get_rels(ctx).size();
       else
         nonalloc += sec->get_rels(ctx).size();
+
+      static LabeledCounter reloc_types("reloc", rel_to_string<E>);
+      for (const ElfRel<E> &rel : sec->get_rels(ctx))
+        reloc_types.add(rel.r_type);
     }
 
     static Counter comdats("comdats");
@@ -3785,6 +4146,7 @@ void show_stats(Context<E> &ctx) {
   }
 
   Counter::print();
+  LabeledCounter::print();
 
   for (ArenaObjectPtr<MergedSection<E>> &sec : ctx.merged_sections)
     sec->print_stats(ctx);
@@ -3801,6 +4163,8 @@ template void resolve_symbols(Context<E> &);
 template void do_lto(Context<E> &);
 template void parse_eh_frame_sections(Context<E> &);
 template void parse_sframe_sections(Context<E> &);
+template void
+preprocess_non_lto_objects(Context<E> &, const std::vector<ObjectFile<E> *> &);
 template void create_merged_sections(Context<E> &);
 template void convert_common_symbols(Context<E> &);
 template void create_output_sections(Context<E> &);
@@ -3818,6 +4182,7 @@ template void sort_init_fini(Context<E> &);
 template void sort_ctor_dtor(Context<E> &);
 template void fixup_ctors_in_init_array(Context<E> &);
 template void shuffle_sections(Context<E> &);
+template void sort_hot_data_sections(Context<E> &);
 template void add_dynamic_strings(Context<E> &);
 template void compute_section_sizes(Context<E> &);
 template void sort_output_sections(Context<E> &);
@@ -3826,6 +4191,7 @@ template void compute_imported_symbol_weakness(Context<E> &);
 template void scan_relocations(Context<E> &);
 template void report_undef_errors(Context<E> &);
 template void create_reloc_sections(Context<E> &);
+template void compute_crel_sizes(Context<E> &);
 template void copy_chunks(Context<E> &);
 template void sort_dynsyms(Context<E> &);
 template void sort_debug_info_sections(Context<E> &);
@@ -139,6 +139,8 @@ static void r_claim_unresolved_symbols(Context<E> &ctx) {
 // are left as zero.
 template <typename E>
 static u64 r_set_osec_offsets(Context<E> &ctx) {
+  Timer t(ctx, "r_set_osec_offsets");
+
   u64 offset = 0;
   for (Chunk<E> *chunk : ctx.chunks) {
     offset = align_to(offset, chunk->shdr.sh_addralign);
@@ -149,7 +151,7 @@ static u64 r_set_osec_offsets(Context<E> &ctx) {
 }
 
 template <typename E>
-void combine_objects(Context<E> &ctx) {
+void combine_objects(Context<E> &ctx, Timer<Context<E>> &t_before_copy) {
   create_output_sections(ctx);
 
   r_create_synthetic_sections(ctx);
@@ -173,11 +175,19 @@ void combine_objects(Context<E> &ctx) {
 
   compute_section_headers(ctx);
 
+  if (ctx.arg.z_crel)
+    compute_crel_sizes(ctx);
+
   i64 filesize = r_set_osec_offsets(ctx);
+  t_before_copy.stop();
+
   ctx.output_file = OutputFile<E>::open(ctx, ctx.arg.output, filesize, 0666);
   ctx.buf = ctx.output_file->buf;
 
+  Timer t_copy(ctx, "copy");
   copy_chunks(ctx);
+  t_copy.stop();
+
   ctx.output_file->close(ctx);
   ctx.checkpoint();
 
@@ -196,6 +206,6 @@ void combine_objects(Context<E> &ctx) {
 
 using E = MOLD_TARGET;
 
-template void combine_objects(Context<E> &);
+template void combine_objects(Context<E> &, Timer<Context<E>> &);
 
 } // namespace mold
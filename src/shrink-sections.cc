@@ -50,16 +50,22 @@
 // including in-section ones, have to be explicitly expressed with
 // relocations.
 //
-// Note that this mechanism only shrinks sections and never enlarges them,
-// as the compiler always emits the longest instruction sequence. This
-// makes the linker implementation a bit simpler because we don't need to
-// worry about oscillation.
+// Note that a section never becomes larger than its original size, as the
+// compiler always emits the longest instruction sequence. However, that
+// doesn't mean that the distance between two locations only decreases as
+// we remove instructions. An alignment directive (R_RISCV_ALIGN or
+// R_LARCH_ALIGN) refers to NOPs whose size depends on the address of
+// their location, so removing instructions before alignment padding may
+// make the padding larger. As a result, a relaxation that was valid in
+// one pass can become invalid in the next pass, and we have to take care
+// of such oscillation.
 
 #if MOLD_RV64LE || MOLD_RV64BE || MOLD_RV32LE || MOLD_RV32BE || \
     MOLD_LOONGARCH64 || MOLD_LOONGARCH32
 
 #include "mold.h"
 
+#include <tbb/parallel_for.h>
 #include <tbb/parallel_for_each.h>
 
 namespace mold {
@@ -74,41 +80,113 @@ i64 get_r_delta(InputSection<E> &isec, u64 offset) {
   return (it == deltas.begin()) ? 0 : (it - 1)->delta;
 }
 
+// Relaxing relocations may allow more relocations to be relaxed because
+// the distance between a branch instruction and its target may decrease
+// as a result of relaxation. Therefore, we repeat the following steps
+// until we reach a fixpoint:
+//
+//  1. Scan sections in the worklist and recompute their r_deltas.
+//  2. Fix symbol values using the new r_deltas.
+//  3. Recompute section sizes and addresses.
+//
+// The first pass scans all executable sections. Only sections containing
+// a relocation whose relaxability depends on the section layout are
+// scanned again in later passes.
+//
+// Each pass checks every relaxation against the current layout, and it
+// undoes a relaxation done by a previous pass if it is no longer valid.
+// Because of alignment padding, that may not converge, so after
+// MAX_PASSES passes we stop relaxing new relocations and only undo
+// invalid ones. Each of those passes undoes at least one relaxation
+// unless nothing changes, so the loop always terminates.
+//
+// We stop only when a pass doesn't change any r_deltas. At that point,
+// every relaxation has been checked against the final layout.
 template <>
 void shrink_sections(Context<E> &ctx) {
   Timer t(ctx, "shrink_sections");
 
-  // Find all relaxable relocations and record how many bytes we can save
-  // into r_deltas.
-  //
-  // Technically speaking, relaxing relocations may allow more relocations
-  // to be relaxed because the distance between a branch instruction and
-  // its target may decrease as a result of relaxation. That said, the
-  // number of such relocations is negligible (I tried to self-host mold
-  // on RISC-V as an experiment and found that the mold-built .text is
-  // only ~0.04% larger than that of GNU ld), so we don't bother to handle
-  // them. We scan relocations only once here.
-  tbb::parallel_for_each(ctx.objs, [&](ObjectFile<E> *file) {
-    for (InputSection<E> *isec : file->sections)
+  constexpr i64 MAX_PASSES = 8;
+  static std::vector<std::unique_ptr<RelaxCounters>> counters;
+
+  // The first pass scans all executable sections.
+  std::vector<std::vector<InputSection<E> *>> worklist(ctx.objs.size());
+
+  tbb::parallel_for((i64)0, (i64)ctx.objs.size(), [&](i64 i) {
+    for (InputSection<E> *isec : ctx.objs[i]->sections)
       if (isec && isec->is_alive() && (isec->shdr().sh_flags & SHF_EXECINSTR))
-        shrink_section(ctx, *isec);
+        worklist[i].push_back(isec);
   });
 
-  // Fix symbol values.
-  tbb::parallel_for_each(ctx.objs, [&](ObjectFile<E> *file) {
-    for (Symbol<E> *sym : file->symbols)
-      if (sym->file == file)
-        if (InputSection<E> *isec = sym->get_input_section())
-          if (isec->shdr().sh_flags & SHF_EXECINSTR)
-            if (i64 delta = get_r_delta(*isec, sym->value))
-              sym->value -= delta;
-  });
+  // We mutate symbol values after each pass, but a scan has to compute
+  // new symbol values from the original ones. So we save the original
+  // values of symbols in sections that will be scanned again.
+  std::vector<std::vector<std::pair<Symbol<E> *, u64>>>
+    orig_values(ctx.objs.size());
 
-  // Recompute sizes of executable sections
-  tbb::parallel_for_each(ctx.chunks, [&](Chunk<E> *chunk) {
-    if (chunk->to_osec() && (chunk->shdr.sh_flags & SHF_EXECINSTR))
-      chunk->compute_section_size(ctx);
-  });
+  for (i64 pass = 0;; pass++) {
+    Timer t2(ctx, "pass" + std::to_string(pass), &t);
+
+    if (counters.size() == pass)
+      counters.emplace_back(new RelaxCounters(pass));
+
+    // Find relaxable relocations and record how many bytes we can
+    // save into r_deltas.
+    std::vector<std::vector<InputSection<E> *>> next(ctx.objs.size());
+    Atomic<bool> changed = false;
+    bool undo_only = (pass >= MAX_PASSES);
+
+    tbb::parallel_for((i64)0, (i64)ctx.objs.size(), [&](i64 i) {
+      for (InputSection<E> *isec : worklist[i]) {
+        ShrinkResult res =
+          shrink_section(ctx, *isec, *counters[pass], undo_only);
+        if (res.needs_rescan)
+          next[i].push_back(isec);
+        if (res.changed)
+          changed = true;
+      }
+    });
+
+    // Fix symbol values.
+    tbb::parallel_for((i64)0, (i64)ctx.objs.size(), [&](i64 i) {
+      ObjectFile<E> *file = ctx.objs[i];
+
+      if (pass > 0) {
+        for (auto [sym, value] : orig_values[i])
+          sym->value = value - get_r_delta(*sym->get_input_section(), value);
+        return;
+      }
+
+      for (Symbol<E> *sym : file->symbols) {
+        if (sym->file != file)
+          continue;
+
+        InputSection<E> *isec = sym->get_input_section();
+        if (!isec || !(isec->shdr().sh_flags & SHF_EXECINSTR))
+          continue;
+
+        if (ranges::binary_search(next[i], isec->shndx, {},
+                                  &InputSection<E>::shndx))
+          orig_values[i].push_back({sym, sym->value});
+
+        if (i64 delta = get_r_delta(*isec, sym->value))
+          sym->value -= delta;
+      }
+    });
+
+    // Recompute sizes of executable sections
+    tbb::parallel_for_each(ctx.chunks, [&](Chunk<E> *chunk) {
+      if (chunk->to_osec() && (chunk->shdr.sh_flags & SHF_EXECINSTR))
+        chunk->compute_section_size(ctx);
+    });
+
+    if (!changed || ranges::all_of(next, [](auto &v) { return v.empty(); }))
+      break;
+
+    // Assign new addresses to sections for the next pass.
+    set_osec_offsets(ctx);
+    worklist = std::move(next);
+  }
 }
 
 // Returns the distance between a relocated place and a symbol.
@@ -123,9 +201,11 @@ i64 compute_distance(Context<E> &ctx, Symbol<E> &sym,
     return INT64_MAX;
 
   // Compute a distance between the relocated place and the symbol.
+  // The relocated place may have been moved by a previous pass of
+  // shrink_sections().
   i64 S = sym.get_addr(ctx);
   i64 A = rel.r_addend;
-  i64 P = isec.get_addr() + rel.r_offset;
+  i64 P = isec.get_addr() + rel.r_offset - get_r_delta(isec, rel.r_offset);
   return S + A - P;
 }
 
@@ -0,0 +1,34 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+# In the second pass, both `tail far` and `tail tgt` become relaxable.
+# Relaxing `tail far` moves `tgt` backward, but the .p2align padding
+# before `site` grows by the same amount, so `site` doesn't move. As a
+# result, `tgt` gets out of JAL's range, and the linker has to undo the
+# relaxation of `tail tgt` in the third pass.
+cat <<EOF | $CC -o $t/a.o -c -xassembler - -march=rv64g
+.globl far, tgt, site
+.text
+far:
+.space 0x100000
+.p2align 3
+  tail far
+tgt:
+.space 0x100000
+.p2align 3
+site:
+  tail tgt
+EOF
+
+cat <<EOF | $CC -o $t/b.o -c -xc -
+#include <stdio.h>
+int main() { printf("Hello world\n"); }
+EOF
+
+$CC -B. -march=rv64g -o $t/exe $t/a.o $t/b.o
+$QEMU $t/exe | grep 'Hello world'
+
+$OBJDUMP -d $t/exe > $t/log
+grep -E '\bj\b.*<far>' $t/log
+grep -A1 '<site>:' $t/log | grep -E '\bauipc\b'
+not grep -E '\bj\b.*<tgt\+' $t/log
@@ -0,0 +1,27 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+# `tail far` is just out of JAL's range in the first pass. The NOPs for
+# .p2align are removed in the first pass, which makes `far` reachable
+# with JAL in the second pass.
+cat <<EOF | $CC -o $t/a.o -c -xassembler - -march=rv64g
+.globl f, far
+.text
+f:
+  tail far
+.p2align 3
+.space 0x100000 - 12
+far:
+  ret
+EOF
+
+cat <<EOF | $CC -o $t/b.o -c -xc -
+#include <stdio.h>
+int main() { printf("Hello world\n"); }
+EOF
+
+$CC -B. -march=rv64g -o $t/exe $t/a.o $t/b.o -Wl,--stats > $t/log
+$QEMU $t/exe | grep 'Hello world'
+$OBJDUMP -d $t/exe | grep -E '\bj\b.*<far>'
+grep -E '^ *relaxed_calls_pass0=' $t/log
+grep -E '^ *relaxed_calls_pass1=[1-9]' $t/log
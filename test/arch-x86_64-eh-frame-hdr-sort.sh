@@ -0,0 +1,68 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+# FDEs are usually in the same order as the functions they describe,
+# but they don't have to be. Here, `hi` is placed after `lo` in .text
+# because of .subsection, but its FDE comes first in .eh_frame.
+cat <<'EOF' | $CC -o $t/a.o -c -x assembler -
+  .text
+  .subsection 1
+  .globl hi
+hi:
+  .cfi_startproc
+  sub $8, %rsp
+  .cfi_def_cfa_offset 16
+  call lo
+  add $8, %rsp
+  .cfi_def_cfa_offset 8
+  ret
+  .cfi_endproc
+
+  .subsection 0
+  .globl lo
+lo:
+  .cfi_startproc
+  sub $8, %rsp
+  .cfi_def_cfa_offset 16
+  call count_frames
+  add $8, %rsp
+  .cfi_def_cfa_offset 8
+  ret
+  .cfi_endproc
+EOF
+
+cat <<EOF | $CC -o $t/b.o -c -xc -
+#include <stdio.h>
+#include <unwind.h>
+
+void hi();
+void lo();
+int n;
+
+static _Unwind_Reason_Code callback(struct _Unwind_Context *ctx, void *arg) {
+  n++;
+  return _URC_NO_REASON;
+}
+
+void count_frames() {
+  _Unwind_Backtrace(callback, NULL);
+}
+
+int main() {
+  hi();
+  printf("%d\n", n >= 4);
+}
+EOF
+
+$CC -B. -o $t/exe $t/a.o $t/b.o
+$QEMU $t/exe | grep 1
+
+# The binary search table in .eh_frame_hdr must be sorted.
+readelf -SW $t/exe | grep -F .eh_frame_hdr > $t/log
+off=$(awk '{ for (i = 1; i < NF; i++) if ($i == "PROGBITS") print $(i + 2) }' $t/log)
+size=$(awk '{ for (i = 1; i < NF; i++) if ($i == "PROGBITS") print $(i + 3) }' $t/log)
+
+od -An -v -t d4 -w8 -j $((0x$off + 12)) -N $((0x$size - 12)) $t/exe |
+  awk '{ print $1 }' > $t/table
+sort -n -c $t/table
+[ $(wc -l < $t/table) -ge 4 ]
@@ -0,0 +1,39 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+cat <<EOF | $CC -o $t/a.o -c -xc - -fPIC -O2
+#include <stdio.h>
+extern int foo;
+extern __thread int bar;
+int *get_foo() { return &foo; }
+int get_bar() { return bar; }
+int main() { printf("%d %d\n", *get_foo(), get_bar()); }
+EOF
+
+cat <<EOF | $CC -o $t/b.o -c -xc - -fPIC
+int foo = 3;
+__thread int bar = 5;
+EOF
+
+$CC -B. -shared -o $t/c.so $t/b.o
+
+$CC -B. -o $t/exe1 $t/a.o $t/b.o -Wl,--stats > $t/log1
+$QEMU $t/exe1 | grep '^3 5$'
+grep -E '^ *reloc\[R_X86_64_REX_GOTPCRELX\]=[1-9]' $t/log1
+grep -E '^ *reloc\[R_X86_64_TLSGD\]=1$' $t/log1
+grep -E '^ *gotpcrelx_relaxed=[1-9]' $t/log1
+grep -E '^ *tlsgd_to_le=1$' $t/log1
+
+$CC -B. -o $t/exe2 $t/a.o $t/c.so -Wl,--stats > $t/log2
+$QEMU $t/exe2 | grep '^3 5$'
+grep -E '^ *gotpcrelx_norelax_dyn=[1-9]' $t/log2
+grep -E '^ *tlsgd_to_ie=1$' $t/log2
+
+# Each GOTPCRELX relocation has exactly one outcome.
+for log in $t/log1 $t/log2; do
+  nrels=$(sed -nE 's/^ *reloc\[R_X86_64_(REX_|CODE_4_)?GOTPCRELX\]=//p' $log |
+          awk '{ n += $1 } END { print n }')
+  nouts=$(sed -nE 's/^ *gotpcrelx_[a-z_]+=//p' $log |
+          awk '{ n += $1 } END { print n }')
+  [ "$nrels" = "$nouts" ]
+done
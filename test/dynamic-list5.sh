@@ -0,0 +1,39 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+# Version script and dynamic list patterns are matched against
+# demangled C++ names in the same pass.
+cat <<EOF | $CXX -o $t/a.o -c -xc++ - -fPIC
+#include <stdio.h>
+void foo(int) { printf("foo1 "); }
+void bar(int) { printf("bar1 "); }
+void baz(int) { printf("baz1 "); }
+void print() { foo(1); bar(1); baz(1); printf("\n"); }
+EOF
+
+cat <<EOF > $t/ver
+VER1 { extern "C++" { "foo(int)"; bar*; print*; }; local: *; };
+EOF
+
+cat <<EOF > $t/dyn
+{ extern "C++" { foo*; "baz(int)"; print*; }; };
+EOF
+
+$CXX -B. -shared -o $t/b.so $t/a.o -Wl,--version-script=$t/ver \
+  -Wl,--dynamic-list=$t/dyn
+
+readelf -W --dyn-syms $t/b.so > $t/log
+grep -q '_Z3fooi@@VER1$' $t/log
+grep -q '_Z3bari@@VER1$' $t/log
+not grep -q _Z3bazi $t/log
+
+cat <<EOF | $CXX -o $t/c.o -c -xc++ -
+#include <stdio.h>
+void print();
+void foo(int) { printf("foo2 "); }
+void bar(int) { printf("bar2 "); }
+int main() { print(); }
+EOF
+
+$CXX -B. -o $t/exe $t/c.o -Wl,-push-state,-no-as-needed $t/b.so -Wl,-pop-state
+$QEMU $t/exe | grep 'foo2 bar1 baz1'
@@ -0,0 +1,53 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+cat <<EOF | $CC -fPIC -c -o $t/a.o -xc -
+int foo1() { return 1; }
+int foo2() { return 2; }
+int xyz_bar() { return 3; }
+int bar() { return 4; }
+__asm__(".symver foo1, foo@VER1");
+__asm__(".symver foo2, foo@@VER2");
+EOF
+
+cat <<EOF > $t/b.ver
+VER1 { local: *; };
+VER2 { global: foo; xyz_bar; bar; };
+EOF
+
+# foo@VER1 and foo@@VER2 share the same string.
+$CC -B. -shared -o $t/c.so $t/a.o -Wl,--version-script=$t/b.ver
+readelf --dyn-syms $t/c.so | grep -F ' foo@VER1'
+readelf --dyn-syms $t/c.so | grep -F ' foo@@VER2'
+readelf -p .dynstr $t/c.so > $t/log1
+[ $(grep -E '\] +foo$' $t/log1 | wc -l) = 1 ]
+grep -E '\] +bar$' $t/log1
+
+# bar refers to the tail of xyz_bar with --tail-merge-strings.
+$CC -B. -shared -o $t/d.so $t/a.o -Wl,--version-script=$t/b.ver \
+  -Wl,--tail-merge-strings
+readelf --dyn-syms $t/d.so | grep -E ' bar@@VER2$'
+readelf -p .dynstr $t/d.so > $t/log2
+not grep -E '\] +bar$' $t/log2
+
+# xyz_bar is 7 bytes long, so it holds bar only if the limit is 7 or
+# more, as is the case for mergeable string sections.
+$CC -B. -shared -o $t/f.so $t/a.o -Wl,--version-script=$t/b.ver \
+  -Wl,--tail-merge-strings=6
+readelf -p .dynstr $t/f.so | grep -E '\] +bar$'
+
+$CC -B. -shared -o $t/g.so $t/a.o -Wl,--version-script=$t/b.ver \
+  -Wl,--tail-merge-strings=7
+readelf -p .dynstr $t/g.so > $t/log3
+not grep -E '\] +bar$' $t/log3
+
+cat <<EOF | $CC -c -o $t/e.o -xc -
+#include <stdio.h>
+int foo();
+int xyz_bar();
+int bar();
+int main() { printf("%d %d %d\n", foo(), xyz_bar(), bar()); }
+EOF
+
+$CC -B. -o $t/exe $t/e.o $t/d.so
+$QEMU $t/exe | grep '^2 3 4$'
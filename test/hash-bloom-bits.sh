@@ -0,0 +1,136 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+# --hash-bloom-bits trades .gnu.hash size for fewer false positives in
+# the bloom filter, and --hash-load-factor trades it for shorter hash
+# chains. `check` looks up every exported symbol of a shared object and
+# 100000 nonexistent names as the dynamic loader would. It prints the
+# percentage of nonexistent names rejected by the bloom filter and the
+# average chain length walked to find an exported symbol, times 100.
+cat <<'EOF' | $CC -o $t/a.o -c -xc -
+#include <elf.h>
+#include <link.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t *hdr, *buckets, *chain;
+static ElfW(Addr) *bloom;
+static ElfW(Sym) *syms;
+static char *strtab;
+
+static uint32_t djb_hash(const char *s) {
+  uint32_t h = 5381;
+  for (; *s; s++)
+    h = h * 33 + (unsigned char)*s;
+  return h;
+}
+
+// Returns a symbol index, -1 if not found or -2 if rejected by the bloom.
+static long lookup(const char *name, long *probes) {
+  uint32_t nbuckets = hdr[0], symoffset = hdr[1];
+  uint32_t nbloom = hdr[2], shift = hdr[3];
+  uint32_t c = sizeof(ElfW(Addr)) * 8;
+  uint32_t h = djb_hash(name);
+
+  ElfW(Addr) word = bloom[(h / c) % nbloom];
+  ElfW(Addr) mask = ((ElfW(Addr))1 << (h % c)) |
+                    ((ElfW(Addr))1 << ((h >> shift) % c));
+  if ((word & mask) != mask)
+    return -2;
+
+  uint32_t i = buckets[h % nbuckets];
+  if (i == 0)
+    return -1;
+
+  for (;; i++) {
+    uint32_t h2 = chain[i - symoffset];
+    (*probes)++;
+    if ((h | 1) == (h2 | 1) && !strcmp(name, strtab + syms[i].st_name))
+      return i;
+    if (h2 & 1)
+      return -1;
+  }
+}
+
+int main(int argc, char **argv) {
+  FILE *f = fopen(argv[1], "rb");
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  char *buf = malloc(size);
+  fread(buf, 1, size, f);
+
+  ElfW(Ehdr) *ehdr = (ElfW(Ehdr) *)buf;
+  ElfW(Shdr) *shdr = (ElfW(Shdr) *)(buf + ehdr->e_shoff);
+  ElfW(Shdr) *gnu_hash = NULL;
+  for (int i = 0; i < ehdr->e_shnum; i++)
+    if (shdr[i].sh_type == SHT_GNU_HASH)
+      gnu_hash = shdr + i;
+
+  ElfW(Shdr) *dynsym = shdr + gnu_hash->sh_link;
+  ElfW(Shdr) *dynstr = shdr + dynsym->sh_link;
+  long num_syms = dynsym->sh_size / sizeof(ElfW(Sym));
+
+  hdr = (uint32_t *)(buf + gnu_hash->sh_offset);
+  bloom = (ElfW(Addr) *)(hdr + 4);
+  buckets = (uint32_t *)(bloom + hdr[2]);
+  chain = buckets + hdr[0];
+  syms = (ElfW(Sym) *)(buf + dynsym->sh_offset);
+  strtab = buf + dynstr->sh_offset;
+
+  long probes = 0;
+  for (long i = hdr[1]; i < num_syms; i++) {
+    if (lookup(strtab + syms[i].st_name, &probes) != i) {
+      printf("not found: %s\n", strtab + syms[i].st_name);
+      return 1;
+    }
+  }
+
+  long rejected = 0, dummy = 0;
+  int n = 100000;
+  for (int i = 0; i < n; i++) {
+    char name[32];
+    sprintf(name, "nonexistent%d", i);
+    long r = lookup(name, &dummy);
+    if (r >= 0)
+      return 1;
+    if (r == -2)
+      rejected++;
+  }
+
+  printf("%ld %ld\n", rejected * 100 / n, probes * 100 / (num_syms - hdr[1]));
+}
+EOF
+
+$CC -B. -o $t/check $t/a.o
+
+for i in $(seq 1 3000); do
+  echo "int fn$i() { return $i; }"
+done | $CC -o $t/b.o -c -xc - -fPIC
+
+$CC -B. -shared -o $t/c.so $t/b.o -Wl,--hash-style=gnu
+$CC -B. -shared -o $t/d.so $t/b.o -Wl,--hash-style=gnu,--hash-bloom-bits=1
+$CC -B. -shared -o $t/e.so $t/b.o -Wl,--hash-style=gnu,--hash-load-factor=1
+
+read reject1 probe1 < <($QEMU $t/check $t/c.so)
+read reject2 probe2 < <($QEMU $t/check $t/d.so)
+read reject3 probe3 < <($QEMU $t/check $t/e.so)
+
+[ $reject1 -ge 90 ]
+[ $reject2 -lt $reject1 ]
+[ $probe3 -lt $probe1 ]
+
+cat <<EOF | $CC -o $t/f.o -c -xc -
+#include <stdio.h>
+int fn1();
+int fn3000();
+int main() { printf("%d\n", fn1() + fn3000()); }
+EOF
+
+$CC -B. -o $t/exe $t/f.o $t/e.so -Wl,--hash-style=gnu
+$QEMU $t/exe | grep '^3001$'
+
+not ./mold -shared -o $t/g.so $t/b.o --hash-bloom-bits=0 2> $t/log
+grep -F 'invalid --hash-bloom-bits argument: 0' $t/log
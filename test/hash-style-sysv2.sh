@@ -0,0 +1,29 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+for i in $(seq 1 3000); do
+  echo "int fn$i() { return $i; }"
+done | $CC -o $t/a.o -c -xc - -fPIC
+
+cat <<EOF > $t/b.ver
+V1 { global: fn1*; };
+V2 { global: *; } V1;
+EOF
+
+$CC -B. -shared -o $t/c.so $t/a.o -Wl,--hash-style=sysv,--version-script=$t/b.ver
+
+readelf --dyn-syms $t/c.so | grep -F ' fn1@@V1'
+readelf --dyn-syms $t/c.so | grep -F ' fn3000@@V2'
+
+cat <<EOF | $CC -o $t/d.o -c -xc -
+#include <stdio.h>
+int fn1();
+int fn2();
+int fn3000();
+int main() { printf("%d\n", fn1() + fn2() + fn3000()); }
+EOF
+
+$CC -B. -o $t/exe $t/d.o $t/c.so -Wl,--hash-style=sysv
+$QEMU $t/exe | grep '^3003$'
+readelf -V $t/exe | grep -F 'Name: V1'
+readelf -V $t/exe | grep -F 'Name: V2'
@@ -0,0 +1,44 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+cat <<EOF | $CC -o $t/a.o -c -xc - -fdata-sections
+#include <stdio.h>
+int x1 = 1;
+char pad1[1000] = {1};
+int x2 = 2;
+char pad2[1000] = {1};
+int x3 = 3;
+char pad3[1000] = {1};
+int x4 = 4;
+
+int main() {
+  printf("%d %d %d %d %d\n", x1, x2, x3, x4, pad1[0] + pad2[0] + pad3[0]);
+}
+EOF
+
+cat <<EOF > $t/hot
+# hottest first
+x3
+x1 write
+x4
+EOF
+
+$CC -B. -o $t/exe $t/a.o -Wl,--hot-data-file=$t/hot
+$QEMU $t/exe | grep '^1 2 3 4 3$'
+
+readelf -sW $t/exe > $t/log
+addr() { printf '%d' 0x$(grep -E " $1\$" $t/log | awk '{ print $2 }'); }
+
+# x3 and x1 are packed together at the beginning of .data, x1 is on
+# its own cache line, and x4 follows on the next cache line.
+[ $(( $(addr x3) + 4 )) -le $(addr x1) ]
+[ $(( $(addr x1) % 64 )) = 0 ]
+[ $(( $(addr x4) - $(addr x1) )) = 64 ]
+[ $(addr x4) -lt $(addr pad1) ]
+[ $(addr x4) -lt $(addr x2) ]
+
+readelf -SW $t/exe | grep -E ' \.data .* 64$'
+
+echo 'x1 read' > $t/hot2
+not $CC -B. -o $t/exe $t/a.o -Wl,--hot-data-file=$t/hot2 2> $t/log
+grep -F 'unknown attribute: read' $t/log
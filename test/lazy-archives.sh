@@ -0,0 +1,62 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+cat <<EOF | $CC -o $t/a.o -c -xc -
+int two() { return 2; }
+EOF
+
+cat <<EOF | $CC -o $t/b.o -c -xc -
+int two();
+int three() { return two() + 1; }
+EOF
+
+cat <<EOF | $CC -o $t/c.o -c -xc -
+int unused() { return 100; }
+EOF
+
+cat <<EOF | $CC -o $t/d.o -c -xc -
+int four() { return 4; }
+EOF
+
+cat <<EOF | $CC -o $t/e.o -c -xc -
+int __wrap_five() { return 5; }
+EOF
+
+cat <<EOF | $CC -fcommon -o $t/f.o -c -xc -
+int six = 6;
+EOF
+
+rm -f $t/x.a
+ar rcs $t/x.a $t/a.o $t/b.o $t/c.o $t/d.o $t/e.o $t/f.o
+
+cat <<EOF | $CC -fcommon -o $t/main.o -c -xc -
+#include <stdio.h>
+int three();
+int five();
+int six;
+int main() { printf("%d\n", three() + five() + six); }
+EOF
+
+# b.o is needed by main.o, and a.o is needed by b.o. d.o is needed
+# only because of -u. e.o is needed because of --wrap, and f.o
+# because it defines a common symbol.
+$CC -B. -o $t/exe $t/main.o $t/x.a -Wl,--lazy-archives,--trace \
+  -Wl,-u,four,--wrap,five > $t/log
+
+grep -F 'x.a(a.o)' $t/log
+grep -F 'x.a(b.o)' $t/log
+not grep -F 'x.a(c.o)' $t/log
+grep -F 'x.a(d.o)' $t/log
+grep -F 'x.a(e.o)' $t/log
+grep -F 'x.a(f.o)' $t/log
+$QEMU $t/exe | grep '^14$'
+
+# An archive without a symbol index is read as usual.
+rm -f $t/y.a
+ar rcS $t/y.a $t/a.o $t/b.o $t/c.o $t/d.o $t/e.o $t/f.o
+
+$CC -B. -o $t/exe $t/main.o $t/y.a -Wl,--lazy-archives,--trace \
+  -Wl,--wrap,five > $t/log
+
+grep -F 'y.a(c.o)' $t/log
+$QEMU $t/exe | grep '^14$'
@@ -0,0 +1,39 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+# Library search directories are listed once and looked up. Make sure
+# that the search order, nonexistent directories and -l:NAME still work.
+cat <<EOF | $CC -o $t/a.o -c -xc - -fPIC
+int foo() { return 3; }
+EOF
+
+cat <<EOF | $CC -o $t/b.o -c -xc - -fPIC
+int foo() { return 5; }
+EOF
+
+mkdir -p $t/dir1 $t/dir2 $t/dir3
+rm -f $t/dir2/libfoo.a $t/dir3/libfoo.a
+ar rcs $t/dir2/libfoo.a $t/a.o
+ar rcs $t/dir3/libfoo.a $t/b.o
+$CC -B. -shared -o $t/dir3/libfoo.so $t/b.o
+
+cat <<EOF | $CC -o $t/c.o -c -xc -
+#include <stdio.h>
+int foo();
+int main() { printf("%d\n", foo()); }
+EOF
+
+$CC -B. -o $t/exe1 $t/c.o -L$t/nonexistent -L$t/dir1 -L$t/dir2 -L$t/dir3 -lfoo
+$QEMU $t/exe1 | grep '^3$'
+
+$CC -B. -o $t/exe2 $t/c.o -L$t/dir3 -L$t/dir2 -lfoo -Wl,-rpath,$t/dir3
+$QEMU $t/exe2 | grep '^5$'
+readelf --dynamic $t/exe2 | grep -F 'libfoo.so'
+
+$CC -B. -o $t/exe3 $t/c.o -L$t/dir1 -L$t/dir3 -l:libfoo.a
+$QEMU $t/exe3 | grep '^5$'
+readelf --dynamic $t/exe3 > $t/log
+not grep -F 'libfoo.so' $t/log
+
+not $CC -B. -o $t/exe4 $t/c.o -L$t/nonexistent -L$t/dir1 -lfoo 2> $t/log
+grep -F 'library not found: foo' $t/log
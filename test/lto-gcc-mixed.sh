@@ -0,0 +1,36 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+echo 'int main() {}' | $GXX -B. -flto -o /dev/null -xc++ - >& /dev/null || skip
+
+# Regular object files are partially processed while LTO is running.
+# Make sure that their exception frames, mergeable strings and comdat
+# members survive.
+cat <<EOF | $GXX -O2 -c -o $t/a.o -xc++ -
+#include <stdexcept>
+const char *hello() { return "Hello world"; }
+void thrower(int x) { if (x) throw std::runtime_error("boom"); }
+inline int inline_fn() { return 42; }
+int call_inline() { return inline_fn(); }
+EOF
+
+cat <<EOF | $GXX -flto -c -o $t/b.o -xc++ -
+#include <cstdio>
+#include <stdexcept>
+const char *hello();
+void thrower(int);
+int call_inline();
+inline int inline_fn() { return 42; }
+int (*fp)() = inline_fn;
+
+int main() {
+  try {
+    thrower(1);
+  } catch (std::exception &e) {
+    printf("%s %s %d\n", hello(), e.what(), call_inline() + fp());
+  }
+}
+EOF
+
+$GXX -B. -o $t/exe -flto $t/a.o $t/b.o
+$QEMU $t/exe | grep 'Hello world boom 84'
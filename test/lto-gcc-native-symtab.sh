@@ -0,0 +1,82 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+echo 'int main() {}' | $GCC -B. -flto -o /dev/null -xc - >& /dev/null || skip
+
+# mold reads the symbol tables of GCC IR files by itself and hands
+# only reachable ones to the plugin. The plugin writes the list of the
+# files it claimed to exe.res if -save-temps is given.
+cat <<EOF | $GCC -flto -c -o $t/a.o -xc -
+#include <stdio.h>
+long long used_array[10];
+short used_var = 5;
+void hello() { printf("Hello world %d %d\n", used_var, (int)used_array[3]); }
+EOF
+
+cat <<EOF | $GCC -flto -c -o $t/b.o -xc -
+void howdy() {}
+EOF
+
+cat <<EOF | $GCC -flto -c -o $t/c.o -xc -
+int unused_var = 3;
+int get_unused_var() { return unused_var; }
+EOF
+
+rm -f $t/d.a
+ar rc $t/d.a $t/a.o $t/b.o $t/c.o
+
+cat <<EOF | $GCC -flto -c -o $t/e.o -xc -
+void hello();
+int main() { hello(); }
+EOF
+
+$GCC -B. -o $t/exe1 -flto -save-temps $t/e.o $t/d.a -Wl,--stats > $t/log
+$QEMU $t/exe1 | grep 'Hello world 5 0'
+grep -E '^ *lto_native_symtabs=[1-9]' $t/log
+
+# Only e.o and a.o are given to the plugin.
+head -1 $t/exe1.res | grep '^2$'
+grep -F 'PREVAILING_DEF_IRONLY hello' $t/exe1.res
+not grep howdy $t/exe1.res
+not grep unused_var $t/exe1.res
+
+# The symbol types and sizes read by mold are verified against the
+# plugin's, and they are kept in the output.
+readelf -W --syms $t/exe1 > $t/log1
+grep -E ' 80 OBJECT .* used_array$' $t/log1
+grep -E ' 2 OBJECT .* used_var$' $t/log1
+grep -E ' FUNC .* hello$' $t/log1
+
+# An object file created by `ld -r` contains multiple symbol tables.
+# mold falls back to the plugin for such a file.
+cat <<EOF | $GCC -flto -c -o $t/f.o -xc -
+long long big_array[10];
+void f1() {}
+EOF
+
+cat <<EOF | $GCC -flto -c -o $t/g.o -xc -
+short small_var;
+void g1() {}
+EOF
+
+ld -r -o $t/fg.o $t/f.o $t/g.o
+
+if [ "$(readelf -SW $t/fg.o | grep -c gnu.lto_.symtab)" = 2 ]; then
+  cat <<EOF | $GCC -flto -c -o $t/h.o -xc -
+#include <stdio.h>
+extern long long big_array[10];
+extern short small_var;
+void f1();
+void g1();
+int main() {
+  f1();
+  g1();
+  printf("%d %d\n", (int)sizeof(big_array), (int)sizeof(small_var));
+}
+EOF
+
+  $GCC -B. -o $t/exe2 -flto -save-temps $t/h.o $t/fg.o
+  $QEMU $t/exe2 | grep '^80 2$'
+  head -1 $t/exe2.res | grep '^2$'
+  grep -F fg.o $t/exe2.res
+fi
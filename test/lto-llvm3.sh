@@ -0,0 +1,49 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+[ $MACHINE = $(uname -m) ] || skip
+
+echo 'int main() {}' | clang -B. -flto -o /dev/null -xc - >& /dev/null || skip
+
+# mold reads symbol tables of LLVM IR files by itself once it has
+# verified that they agree with the LTO plugin's ones.
+cat <<EOF | clang -flto -c -o $t/a.o -xc -
+int foo() { return 3; }
+EOF
+
+cat <<EOF | clang -flto -c -o $t/b.o -xc -
+__attribute__((weak)) int bar() { return 4; }
+__attribute__((visibility("hidden"))) int baz = 5;
+inline int cd() { return 7; }
+int (*cd_ptr)() = cd;
+EOF
+
+cat <<EOF | clang -flto -c -o $t/c.o -xc -
+int unused() { return 1; }
+int foo() { return 99; }
+EOF
+
+cat <<EOF | clang -flto -c -o $t/d.o -xc -
+int qux() { return 6; }
+EOF
+
+rm -f $t/e.a
+ar rcs $t/e.a $t/c.o $t/d.o
+
+cat <<EOF | clang -flto -c -o $t/f.o -xc -
+#include <stdio.h>
+int foo();
+__attribute__((weak)) int bar();
+extern __attribute__((visibility("hidden"))) int baz;
+int qux();
+extern int (*cd_ptr)();
+int main() { printf("%d\n", foo() + bar() + baz + qux() + cd_ptr()); }
+EOF
+
+clang -B. -o $t/exe -flto $t/f.o $t/a.o $t/b.o $t/e.a -Wl,--stats > $t/log
+$QEMU $t/exe | grep '^25$'
+
+# The first file is read by the plugin. Make sure that we didn't fall
+# back to the plugin for the others.
+grep -E '^ *lto_plugin_symtabs=[1-9]' $t/log
+grep -E '^ *lto_native_symtabs=[1-9]' $t/log
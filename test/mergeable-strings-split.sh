@@ -0,0 +1,58 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+# Split wide mergeable strings in non-alloc sections and merge them.
+# Some characters contain null bytes but aren't null characters. If
+# one of them is taken as a terminator, the number of fragments or the
+# size of the merged section changes.
+#
+# gen <first> <last> <entsize> emits strings "<first>" to "<last>".
+# If the fourth argument is 1, it prints the merged size of the strings instead.
+gen() {
+  awk -v lo=$1 -v hi=$2 -v entsize=$3 -v size=$4 '
+  BEGIN {
+    dir = (entsize == 2) ? ".2byte" : ".4byte";
+    wide = (entsize == 2) ? 256 : 65536;
+    total = 0;
+    for (i = lo; i <= hi; i++) {
+      n = 0;
+      for (j = 1; j <= length(i ""); j++)
+        c[n++] = 48 + substr(i "", j, 1);
+      if (i % 3 == 0)
+        c[n++] = wide;
+      if (i % 5 == 0)
+        c[n++] = wide + 1;
+      c[n++] = 0;
+
+      total += n * entsize;
+      if (!size)
+        for (j = 0; j < n; j++)
+          print dir, c[j];
+    }
+    if (size)
+      print total;
+  }'
+}
+
+gen_obj() {
+  echo '.section .foo, "MS", @progbits, 2'
+  gen $1 $2 2 0
+  echo '.section .bar, "MS", @progbits, 4'
+  gen $1 $2 4 0
+}
+
+gen_obj 1 1000 | $CC -o $t/a.o -c -xassembler -
+gen_obj 501 1500 | $CC -o $t/b.o -c -xassembler -
+
+cat <<EOF | $CC -o $t/c.o -c -xassembler -
+.globl _start
+_start:
+EOF
+
+# Link only these files so that no other mergeable strings are counted.
+./mold -o $t/exe $t/a.o $t/b.o $t/c.o --stats > $t/log
+grep -E '^ *string_fragments=4000$' $t/log
+
+$OBJCOPY --dump-section .foo=$t/foo --dump-section .bar=$t/bar $t/exe
+[ $(wc -c < $t/foo) = $(gen 1 1500 2 1) ]
+[ $(wc -c < $t/bar) = $(gen 1 1500 4 1) ]
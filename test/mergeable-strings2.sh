@@ -0,0 +1,48 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+# Wide strings are split a word at a time. Use strings of various
+# lengths whose characters contain null bytes to make sure that only
+# whole null characters are taken as terminators.
+cat <<EOF | $CC -o $t/a.o -c -xc - -O2
+#include <uchar.h>
+
+char16_t *a16[] = { u"", u"\x0100", u"a\x0100\x0001", u"abcd\x0100xyz", u"abc" };
+char32_t *a32[] = { U"", U"\x10000", U"a\x0100\x10001", U"abcd\x10000xy" };
+EOF
+
+cat <<EOF | $CC -o $t/b.o -c -xc - -O2
+#include <stdio.h>
+#include <uchar.h>
+
+extern char16_t *a16[];
+extern char32_t *a32[];
+
+char16_t *b16[] = { u"", u"\x0100", u"a\x0100\x0001", u"abcd\x0100xyz", u"abc" };
+char32_t *b32[] = { U"", U"\x10000", U"a\x0100\x10001", U"abcd\x10000xy" };
+
+// These differ from a16[1] and a32[1] only in bytes that are not null.
+// They must not be merged with them.
+char16_t *c16 = u"\x0200";
+char32_t *c32 = U"\x20000";
+
+int main() {
+  int len = 0;
+  for (int i = 0; i < 5; i++)
+    for (char16_t *p = a16[i]; *p; p++)
+      len++;
+  for (int i = 0; i < 4; i++)
+    for (char32_t *p = a32[i]; *p; p++)
+      len++;
+  printf("%d ", len);
+
+  for (int i = 0; i < 5; i++)
+    printf("%d", a16[i] == b16[i]);
+  for (int i = 0; i < 4; i++)
+    printf("%d", a32[i] == b32[i]);
+  printf(" %d%d %x %x\n", a16[1] == c16, a32[1] == c32, c16[0], c32[0]);
+}
+EOF
+
+$CC -B. -o $t/exe $t/a.o $t/b.o -no-pie
+$QEMU $t/exe | grep -E '^26 111111111 00 200 20000$'
@@ -0,0 +1,38 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+# --synthesize-sframe converts .eh_frame to .sframe for input files
+# that don't have .sframe.
+[ $MACHINE = x86_64 -o $MACHINE = aarch64 ] || skip
+
+cat <<EOF | $CC -O0 -fno-omit-frame-pointer -o $t/a.o -c -xc -
+#include <stdio.h>
+int foo(int x) { return x + 1; }
+int main() { printf("Hello %d\n", foo(2)); }
+EOF
+
+# A function whose CFA is defined by a DWARF expression can't be
+# described by SFrame.
+cat <<EOF | $CC -o $t/b.o -c -xc -
+__asm__(".globl cfa_expr\n"
+        ".type cfa_expr, @function\n"
+        "cfa_expr:\n"
+        ".cfi_startproc\n"
+        ".cfi_escape 0x0f, 0x02, 0x77, 0x08\n"
+        "ret\n"
+        ".cfi_endproc\n");
+EOF
+
+$CC -B. -o $t/exe1 $t/a.o $t/b.o
+readelf -SW $t/exe1 | not grep -F .sframe
+
+$CC -B. -o $t/exe2 $t/a.o $t/b.o -Wl,--synthesize-sframe \
+  -Wl,--print-sframe-failures > $t/log
+$QEMU $t/exe2 | grep 'Hello 3'
+
+readelf -SW $t/exe2 | grep -F .sframe
+readelf -Wl $t/exe2 | grep GNU_SFRAME
+
+grep 'cfa_expr: CFA is defined by a DWARF expression' $t/log
+not grep -w main $t/log
+not grep -w foo $t/log
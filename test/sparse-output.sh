@@ -0,0 +1,19 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+cat <<EOF | $CC -o $t/a.o -c -xc -
+#include <stdio.h>
+int main() { printf("Hello world\n"); }
+EOF
+
+# Paddings between segments are not written to a fresh file.
+rm -f $t/exe1
+$CC -B. -o $t/exe1 $t/a.o -Wl,-z,separate-loadable-segments,--stats > $t/log
+grep -E 'padding_skipped_pages=[1-9]' $t/log
+$QEMU $t/exe1 | grep 'Hello world'
+
+# They are cleared if we overwrite an existing file.
+head -c 1000000 /dev/urandom > $t/exe2
+chmod 755 $t/exe2
+$CC -B. -o $t/exe2 $t/a.o -Wl,-z,separate-loadable-segments
+cmp $t/exe1 $t/exe2
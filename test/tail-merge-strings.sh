@@ -0,0 +1,41 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+cat <<EOF | $CC -o $t/a.o -c -xc - -O2
+#include <uchar.h>
+char *a1 = "foobar";
+char *a2 = "xyz";
+char16_t *a3 = u"foobar";
+EOF
+
+cat <<EOF | $CC -o $t/b.o -c -xc - -O2
+#include <stdio.h>
+#include <uchar.h>
+
+extern char *a1, *a2;
+extern char16_t *a3;
+char *b1 = "bar";
+char *b2 = "r";
+char *b3 = "bax";
+char16_t *b4 = u"bar";
+
+int main() {
+  printf("%s %s %s %s %d %d %d\n", a1, b1, b2, b3,
+         (int)(b1 - a1), (int)(b2 - a1), (int)(b4 - a3));
+}
+EOF
+
+$CC -B. -o $t/exe1 $t/a.o $t/b.o -no-pie
+$QEMU $t/exe1 | grep '^foobar bar r bax '
+
+$CC -B. -o $t/exe2 $t/a.o $t/b.o -no-pie -Wl,--tail-merge-strings
+$QEMU $t/exe2 | grep '^foobar bar r bax 3 5 3$'
+
+# Strings longer than the given length are not merged.
+$CC -B. -o $t/exe3 $t/a.o $t/b.o -no-pie -Wl,--tail-merge-strings=3
+$QEMU $t/exe3 > $t/log
+not grep ' 3 5 3$' $t/log
+
+# The length doesn't count the terminating null character, so "r" is
+# merged into "bar".
+awk '{ exit !($6 - $5 == 2) }' $t/log
@@ -0,0 +1,47 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+# OneTBB isn't tsan-clean
+nm mold | grep '__tsan_init' && skip
+
+cat <<EOF | $CC -c -o $t/a.o -xc -
+#include <stdio.h>
+int x = 3;
+int *p = &x;
+void hello() { printf("Hello world %d\n", *p); }
+EOF
+
+cat <<EOF | $CC -c -o $t/b.o -xc -
+void hello();
+int main() { hello(); }
+EOF
+
+# CREL output is rejected on REL-type targets
+if [[ $MACHINE = arm* ]] || [ $MACHINE = i686 ]; then
+  not ./mold -r -z crel -o $t/d.o $t/a.o $t/b.o 2> $t/log
+  grep -F -- '-z crel may not be used on' $t/log
+  exit
+fi
+
+./mold -r -o $t/c.o $t/a.o $t/b.o
+./mold -r -z crel -o $t/d.o $t/a.o $t/b.o
+
+readelf -S $t/d.o > $t/log
+grep -F .crel.text $t/log
+grep -F .crel.data $t/log
+not grep -F .rela.text $t/log
+
+# Converting CREL back to RELA should yield the same relocations.
+./mold -r -o $t/e.o $t/d.o
+
+readelf -r $t/c.o | awk '/^[0-9a-f]+ / { print $1, $3, $5, $6, $7 }' > $t/log1
+readelf -r $t/e.o | awk '/^[0-9a-f]+ / { print $1, $3, $5, $6, $7 }' > $t/log2
+[ -s $t/log1 ]
+diff $t/log1 $t/log2
+
+$CC -B. -o $t/exe1 $t/d.o
+$QEMU $t/exe1 | grep 'Hello world 3'
+
+$CC -B. -o $t/exe2 $t/a.o $t/b.o -Wl,--emit-relocs,-z,crel
+$QEMU $t/exe2 | grep 'Hello world 3'
+readelf -S $t/exe2 | grep -F .crel.text
@@ -0,0 +1,22 @@
+#!/usr/bin/env bash
+. $(dirname $0)/common.inc
+
+cat <<EOF | $CC -o $t/a.o -c -xc - -O2
+#include <stdio.h>
+__attribute__((hot)) int hot(int x) { return x * 3; }
+__attribute__((cold)) int cold(int x) { return x * 5; }
+int main() { printf("%d\n", hot(1) + cold(2)); }
+EOF
+
+$CC -B. -o $t/exe1 $t/a.o -Wl,-z,hugepage-text
+$QEMU $t/exe1 | grep '^13$'
+
+readelf -SW $t/exe1 | grep -E ' \.text +PROGBITS +0*[0-9a-f]*[02468ace]00000 [0-9a-f]*[02468ace]00000 '
+readelf -lW $t/exe1 | grep -E 'LOAD .* 0x[0-9a-f]*[02468ace]00000 R E 0x200000$'
+
+$CC -B. -o $t/exe2 $t/a.o -Wl,-z,hugepage-text,-z,keep-text-section-prefix
+$QEMU $t/exe2 | grep '^13$'
+
+readelf -SW $t/exe2 | grep -E ' \.text\.hot +PROGBITS +0*[0-9a-f]*[02468ace]00000 '
+readelf -SW $t/exe2 > $t/log
+not grep -E ' \.text\.unlikely +PROGBITS +0*[0-9a-f]*[02468ace]00000 ' $t/log